@@ -0,0 +1,268 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C++
+*
+*   lua embed * pooled memory allocator for the lua state
+*
+*   Most allocations of a lua state are small objects of a few fixed sizes: tables, short
+*   strings, closures and upvalues. Each size class gets a pool that carves pages into blocks
+*   of its size and keeps the freed blocks in a list, so allocating and freeing one is a
+*   pointer swap instead of a call into malloc.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "lua_allocator.h"
+
+#include <stdbool.h>    // Required for: bool
+#include <stdio.h>      // Required for: fprintf
+#include <stdlib.h>     // Required for: malloc, realloc, free
+#include <string.h>     // Required for: memset, memcpy
+
+struct LuaAllocatorBlock
+{
+    LuaAllocatorBlock* Next;
+};
+
+// the header is as large as a block class step, so the blocks after it stay aligned like the
+// blocks of malloc
+struct LuaAllocatorPage
+{
+    LuaAllocatorPage* Next;
+    char Padding[LUA_ALLOCATOR_CLASS_STEP - sizeof(LuaAllocatorPage*)];
+};
+
+static int GetSizeClass(size_t size)
+{
+    return (int)((size - 1) / LUA_ALLOCATOR_CLASS_STEP);
+}
+
+static size_t GetClassSize(int sizeClass)
+{
+    return (size_t)(sizeClass + 1) * LUA_ALLOCATOR_CLASS_STEP;
+}
+
+// lua expects shrinking a block to always work, so blocks that shrink ignore the limit
+static bool CanReserve(const LuaAllocator* allocator, size_t size, bool shrinking)
+{
+    return shrinking || allocator->LimitBytes == 0 || allocator->ReservedBytes + size <= allocator->LimitBytes;
+}
+
+static void* AllocPooled(LuaAllocator* allocator, int sizeClass, bool shrinking)
+{
+    LuaAllocatorPool* pool = &allocator->Pools[sizeClass];
+    size_t blockSize = GetClassSize(sizeClass);
+
+    LuaAllocatorBlock* block = pool->FreeList;
+    if (block)
+    {
+        pool->FreeList = block->Next;
+        return block;
+    }
+
+    if (pool->Unused + blockSize > pool->UnusedEnd)
+    {
+        if (!CanReserve(allocator, LUA_ALLOCATOR_PAGE_SIZE, shrinking))
+            return NULL;
+
+        LuaAllocatorPage* page = malloc(LUA_ALLOCATOR_PAGE_SIZE);
+        if (!page)
+            return NULL;
+
+        page->Next = pool->Pages;
+        pool->Pages = page;
+        pool->Unused = (char*)(page + 1);
+        pool->UnusedEnd = (char*)page + LUA_ALLOCATOR_PAGE_SIZE;
+        pool->PageBytes += LUA_ALLOCATOR_PAGE_SIZE;
+        allocator->ReservedBytes += LUA_ALLOCATOR_PAGE_SIZE;
+    }
+
+    void* unused = pool->Unused;
+    pool->Unused += blockSize;
+    return unused;
+}
+
+static void FreePooled(LuaAllocator* allocator, void* memory, int sizeClass)
+{
+    LuaAllocatorPool* pool = &allocator->Pools[sizeClass];
+    LuaAllocatorBlock* block = memory;
+    block->Next = pool->FreeList;
+    pool->FreeList = block;
+}
+
+static void TrackBlock(LuaAllocator* allocator, size_t size)
+{
+    if (size <= LUA_ALLOCATOR_MAX_POOLED_SIZE)
+    {
+        LuaAllocatorPool* pool = &allocator->Pools[GetSizeClass(size)];
+        pool->UsedBytes += size;
+        pool->UsedBlocks++;
+    }
+    else
+    {
+        allocator->LargeBytes += size;
+        allocator->LargeBlocks++;
+        allocator->ReservedBytes += size;
+    }
+
+    allocator->UsedBytes += size;
+    if (allocator->UsedBytes > allocator->PeakBytes)
+        allocator->PeakBytes = allocator->UsedBytes;
+}
+
+static void UntrackBlock(LuaAllocator* allocator, size_t size)
+{
+    if (size <= LUA_ALLOCATOR_MAX_POOLED_SIZE)
+    {
+        LuaAllocatorPool* pool = &allocator->Pools[GetSizeClass(size)];
+        pool->UsedBytes -= size;
+        pool->UsedBlocks--;
+    }
+    else
+    {
+        allocator->LargeBytes -= size;
+        allocator->LargeBlocks--;
+        allocator->ReservedBytes -= size;
+    }
+
+    allocator->UsedBytes -= size;
+}
+
+void InitLuaAllocator(LuaAllocator* allocator, size_t limitBytes)
+{
+    memset(allocator, 0, sizeof(LuaAllocator));
+    allocator->LimitBytes = limitBytes;
+}
+
+void UnloadLuaAllocator(LuaAllocator* allocator)
+{
+    for (int i = 0; i < LUA_ALLOCATOR_CLASS_COUNT; i++)
+    {
+        LuaAllocatorPage* page = allocator->Pools[i].Pages;
+        while (page)
+        {
+            LuaAllocatorPage* next = page->Next;
+            free(page);
+            page = next;
+        }
+    }
+
+    InitLuaAllocator(allocator, allocator->LimitBytes);
+}
+
+void* LuaAllocatorAlloc(void* userData, void* block, size_t oldSize, size_t newSize)
+{
+    LuaAllocator* allocator = userData;
+
+    // for new blocks lua passes the type of the object instead of the old size
+    if (!block)
+        oldSize = 0;
+
+    if (newSize == 0)
+    {
+        if (block)
+        {
+            if (oldSize <= LUA_ALLOCATOR_MAX_POOLED_SIZE)
+                FreePooled(allocator, block, GetSizeClass(oldSize));
+            else
+                free(block);
+
+            UntrackBlock(allocator, oldSize);
+        }
+        return NULL;
+    }
+
+    bool shrinking = newSize <= oldSize;
+    bool oldPooled = block && oldSize <= LUA_ALLOCATOR_MAX_POOLED_SIZE;
+    bool newPooled = newSize <= LUA_ALLOCATOR_MAX_POOLED_SIZE;
+    void* newBlock = NULL;
+
+    if (oldPooled && newPooled && GetSizeClass(oldSize) == GetSizeClass(newSize))
+    {
+        // the block already has room for the new size
+        newBlock = block;
+    }
+    else if (block && !oldPooled && !newPooled)
+    {
+        if (!CanReserve(allocator, newSize - oldSize, shrinking))
+            return NULL;
+
+        newBlock = realloc(block, newSize);
+    }
+    else
+    {
+        if (newPooled)
+            newBlock = AllocPooled(allocator, GetSizeClass(newSize), shrinking);
+        else if (CanReserve(allocator, newSize, shrinking))
+            newBlock = malloc(newSize);
+
+        if (newBlock && block)
+        {
+            memcpy(newBlock, block, oldSize < newSize ? oldSize : newSize);
+            if (oldPooled)
+                FreePooled(allocator, block, GetSizeClass(oldSize));
+            else
+                free(block);
+        }
+    }
+
+    if (!newBlock)
+        return NULL;
+
+    if (block)
+        UntrackBlock(allocator, oldSize);
+    TrackBlock(allocator, newSize);
+    return newBlock;
+}
+
+static int LuaAllocatorPanic(lua_State* luaState)
+{
+    const char* message = lua_tostring(luaState, -1);
+    fprintf(stderr, "PANIC: unprotected error in call to Lua API (%s)\n", message ? message : "error object is not a string");
+    return 0;
+}
+
+lua_State* NewLuaStateWithAllocator(LuaAllocator* allocator)
+{
+    lua_State* luaState = lua_newstate(LuaAllocatorAlloc, allocator);
+    if (luaState)
+        lua_atpanic(luaState, LuaAllocatorPanic);
+    return luaState;
+}
+
+float GetLuaAllocatorFragmentation(const LuaAllocator* allocator)
+{
+    size_t pageBytes = 0;
+    size_t usedBytes = 0;
+    for (int i = 0; i < LUA_ALLOCATOR_CLASS_COUNT; i++)
+    {
+        pageBytes += allocator->Pools[i].PageBytes;
+        usedBytes += allocator->Pools[i].UsedBytes;
+    }
+
+    if (pageBytes == 0)
+        return 0;
+
+    return 1.0f - (float)usedBytes / (float)pageBytes;
+}
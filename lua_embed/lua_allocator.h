@@ -0,0 +1,82 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C++
+*
+*   lua embed * pooled memory allocator for the lua state
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+**********************************************************************************************/
+
+#ifndef LUA_ALLOCATOR_H
+#define LUA_ALLOCATOR_H
+
+#include <stddef.h>
+
+#include "lua.h"
+
+// blocks up to this size come from the pools, one pool per 16 bytes of size. Tables, short
+// strings, closures and upvalues all fit into the pools, larger blocks are passed to malloc.
+#define LUA_ALLOCATOR_CLASS_STEP 16
+#define LUA_ALLOCATOR_CLASS_COUNT 16
+#define LUA_ALLOCATOR_MAX_POOLED_SIZE (LUA_ALLOCATOR_CLASS_STEP * LUA_ALLOCATOR_CLASS_COUNT)
+
+// the pools take memory from the system in pages of this size and never give it back before
+// the allocator is unloaded
+#define LUA_ALLOCATOR_PAGE_SIZE (16 * 1024)
+
+typedef struct LuaAllocatorBlock LuaAllocatorBlock;
+typedef struct LuaAllocatorPage LuaAllocatorPage;
+
+typedef struct
+{
+    // free blocks of the size class
+    LuaAllocatorBlock* FreeList;
+    // pages of the size class that were handed out block by block
+    LuaAllocatorPage* Pages;
+    // the part of the newest page that was never handed out
+    char* Unused;
+    char* UnusedEnd;
+    // sizes lua asked for of the blocks in use
+    size_t UsedBytes;
+    size_t UsedBlocks;
+    // bytes of the pages of the class
+    size_t PageBytes;
+}LuaAllocatorPool;
+
+// memory of one lua state: small blocks come from free lists per size class, so the many small
+// objects of the lua state don't go through malloc. Lua knows the size of each block it frees,
+// so the blocks carry no header.
+typedef struct
+{
+    LuaAllocatorPool Pools[LUA_ALLOCATOR_CLASS_COUNT];
+    // blocks larger than LUA_ALLOCATOR_MAX_POOLED_SIZE
+    size_t LargeBytes;
+    size_t LargeBlocks;
+    // bytes lua has allocated and the most it had at any time
+    size_t UsedBytes;
+    size_t PeakBytes;
+    // bytes taken from the system, the pages of all pools and the large blocks
+    size_t ReservedBytes;
+    // allocations that would raise ReservedBytes above the limit fail and raise a memory error
+    // in lua, 0 if there is no limit
+    size_t LimitBytes;
+}LuaAllocator;
+
+void InitLuaAllocator(LuaAllocator* allocator, size_t limitBytes);
+// frees all pages, the lua state using the allocator must be closed before
+void UnloadLuaAllocator(LuaAllocator* allocator);
+
+// the lua_Alloc function, the user data is the allocator
+void* LuaAllocatorAlloc(void* userData, void* block, size_t oldSize, size_t newSize);
+
+// creates a lua state that gets all its memory from the allocator, NULL if that failed
+lua_State* NewLuaStateWithAllocator(LuaAllocator* allocator);
+
+// share of the pages that doesn't hold data lua asked for: free blocks, the rest of the newest
+// pages and the rounding of the sizes up to their class
+float GetLuaAllocatorFragmentation(const LuaAllocator* allocator);
+
+#endif
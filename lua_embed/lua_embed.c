@@ -32,10 +32,18 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "lua.h"
 #include "lualib.h"
 #include "lauxlib.h"
 
+#include "lua_allocator.h"
+#include "lua_gc_scheduler.h"
+#include "script_workers.h"
+#include "script_bundle.h"
+
 typedef struct 
 {
     Vector2 Position;
@@ -54,10 +62,92 @@ Entity Player = { 0 };
 
 #define MAX_ENIMIES 3
 #define MAX_BULLETS 100
+
+// the scripts can't take more memory than this, allocations above it raise a memory error in lua
+#define SCRIPT_MEMORY_LIMIT (64 * 1024 * 1024)
+
+// time the garbage collector of the scripts may take after each frame
+#define SCRIPT_GC_BUDGET_MICROSECONDS 1000
+
+// the enemies are split between this many lua states, the states run their behaviors at the
+// same time on worker threads
+#define SCRIPT_SHARD_COUNT 2
+
+// errors a shard keeps for the main thread to log in one frame, more are only counted
+#define MAX_SCRIPT_ERRORS 16
+#define MAX_SCRIPT_ERROR_LENGTH 256
+
 Entity Enemies[MAX_ENIMIES] = { 0 };
 Bullet Bullets[MAX_BULLETS] = { 0 };
 
 
+// game actions shared by the bound functions and the batched commands of the scripts
+
+void TurnEnemyTowardPlayer(int index)
+{
+    Vector2 vectorToPlayer = Vector2Normalize(Vector2Subtract(Player.Position, Enemies[index].Position));
+
+    float angle = atan2(vectorToPlayer.y, vectorToPlayer.x) * RAD2DEG;
+    Enemies[index].Angle = angle;
+}
+
+bool FireEnemyBullet(int index, float speed)
+{
+    if (Enemies[index].ReloadTime > 0)
+        return false;
+
+    int slot = -1;
+    // find an empty bullet slot
+    for (int i = 0; i < MAX_BULLETS; i++)
+    {
+        if (Bullets[i].Lifetime <= 0)
+        {
+            slot = i;
+            break;
+        }
+    }
+
+    if (slot < 0)
+        return false;
+
+    Bullets[slot].Velocity = (Vector2){ cosf(DEG2RAD * Enemies[index].Angle), sinf(DEG2RAD * Enemies[index].Angle) };
+    Bullets[slot].Position = Vector2Add(Enemies[index].Position, Vector2Scale(Bullets[slot].Velocity, 25));
+    Bullets[slot].Velocity = Vector2Scale(Bullets[slot].Velocity, speed);
+    Bullets[slot].Lifetime = 3;
+
+    Enemies[index].ReloadTime = 1;
+    return true;
+}
+
+// changes of the game state by the scripts. The script states run at the same time on the
+// workers, so they don't change the game state themselves but collect commands that are applied
+// in a fixed order after all of them are done.
+typedef enum
+{
+    SCRIPT_COMMAND_AIM,
+    SCRIPT_COMMAND_FIRE,
+    SCRIPT_COMMAND_MOVE,
+}ScriptCommandType;
+
+typedef struct
+{
+    ScriptCommandType Type;
+    int Enemy;
+    // the new position of a move, the bullet speed of a fire in x
+    Vector2 Value;
+}ScriptCommand;
+
+typedef struct ScriptShard ScriptShard;
+
+void PushScriptCommand(ScriptShard* shard, ScriptCommandType type, int enemy, Vector2 value);
+
+// the shard of a lua state is kept in the extra space of the state, the coroutine threads of
+// the state get a copy of it
+ScriptShard* GetScriptShard(lua_State* luaState)
+{
+    return *(ScriptShard**)lua_getextraspace(luaState);
+}
+
 // functions bound to lua
 // these are a series of functions that let the lua behavior script get info and change the game state.
 
@@ -84,8 +174,8 @@ int LuaGetEnemyPosY(lua_State* luaState)
 int LuaMovePlayer(lua_State* luaState)
 {
     int index = (int)luaL_checkinteger(luaState, 1);
-    Enemies[index].Position.x = (float)luaL_checknumber(luaState, 2);
-    Enemies[index].Position.y = (float)luaL_checknumber(luaState, 3);
+    Vector2 position = { (float)luaL_checknumber(luaState, 2), (float)luaL_checknumber(luaState, 3) };
+    PushScriptCommand(GetScriptShard(luaState), SCRIPT_COMMAND_MOVE, index, position);
     return 0;
 }
 
@@ -111,10 +201,7 @@ int LuaTurnTowardPlayer(lua_State* luaState)
     int index = (int)luaL_checkinteger(luaState, 1);
     float speed = (float)luaL_checknumber(luaState, 2);
 
-    Vector2 vectorToPlayer = Vector2Normalize(Vector2Subtract(Player.Position, Enemies[index].Position));
-
-    float angle = atan2(vectorToPlayer.y, vectorToPlayer.x) * RAD2DEG;
-    Enemies[index].Angle = angle;
+    PushScriptCommand(GetScriptShard(luaState), SCRIPT_COMMAND_AIM, index, (Vector2){ 0 });
 
     lua_pushboolean(luaState, true);
     return 1;
@@ -133,36 +220,25 @@ int LuaEnemyFire(lua_State* luaState)
     int index = (int)luaL_checkinteger(luaState, 1);
     float speed = (float)luaL_checknumber(luaState, 2);
 
-    bool canFire = false;
-
-    if (Enemies[index].ReloadTime <= 0)
-    {
-        int slot = -1;
-        // find an empty bullet slot
-        for (int i = 0; i < MAX_BULLETS; i++)
-        {
-            if (Bullets[i].Lifetime <= 0)
-            {
-                slot = i;
-                break;
-            }
-        }
-
-        if (slot >= 0)
-        {
-            canFire = true;
+    PushScriptCommand(GetScriptShard(luaState), SCRIPT_COMMAND_FIRE, index, (Vector2){ speed, 0 });
 
-            Bullets[slot].Velocity = (Vector2){ cosf(DEG2RAD * Enemies[index].Angle), sinf(DEG2RAD * Enemies[index].Angle) };
-            Bullets[slot].Position = Vector2Add(Enemies[index].Position, Vector2Scale(Bullets[slot].Velocity, 25));
-            Bullets[slot].Velocity = Vector2Scale(Bullets[slot].Velocity, speed);
-            Bullets[slot].Lifetime = 3;
+    // the bullet is fired with the other commands, it only misses if all bullets are in use
+    lua_pushboolean(luaState, Enemies[index].ReloadTime <= 0);
+    return 1;
+}
 
-            Enemies[index].ReloadTime = 1;
-        }
-    }
+// wait(seconds) suspends the behavior of the enemy for the given time
+int LuaWait(lua_State* luaState)
+{
+    luaL_checknumber(luaState, 1);
+    lua_settop(luaState, 1);
+    return lua_yield(luaState, 1);
+}
 
-    lua_pushboolean(luaState, canFire);
-    return 1;
+// yield() suspends the behavior of the enemy until the next frame
+int LuaYield(lua_State* luaState)
+{
+    return lua_yield(luaState, 0);
 }
 
 // loads bound functions into lua state
@@ -177,21 +253,91 @@ void PushLuaAPI(lua_State* luaState)
     lua_register(luaState, "MovePlayer", LuaMovePlayer);
     lua_register(luaState, "DistanceToPlayer", LuaDistanceToPlayer);
     lua_register(luaState, "TurnTowardPlayer", LuaTurnTowardPlayer);
+    lua_register(luaState, "wait", LuaWait);
+    lua_register(luaState, "yield", LuaYield);
+}
+
+// queues the error message on top of the stack for the shard of the state and pops it, the
+// messages are logged on the main thread once all shards are done
+void ReportScriptError(lua_State* luaState);
+
+// a script compiled once into a lua function, the function is kept in the registry so it can be
+// called any number of times without reading and parsing the file again
+typedef struct
+{
+    const char* File;
+    // bundle with the precompiled script, NULL to always compile the source
+    const ScriptBundle* Bundle;
+    // modification time of the source and version of the bundle when the script was compiled
+    long ModTime;
+    int BundleVersion;
+    int FunctionRef;
+}LuaScript;
+
+// loads the precompiled chunk from the bundle, unless the source was saved after the bundle was
+// built, and compiles the source otherwise
+int LoadLuaScriptChunk(lua_State* luaState, const LuaScript* script)
+{
+    const ScriptBundle* bundle = script->Bundle;
+    if (bundle && bundle->ModTime >= script->ModTime)
+    {
+        const ScriptBundleEntry* entry = FindScriptBundleChunk(bundle, script->File);
+        if (entry)
+            return LoadScriptBundleChunk(luaState, bundle, entry);
+    }
+
+    return luaL_loadfile(luaState, script->File);
 }
 
-// runs the file as a lua script
-void RunLuaScript(lua_State* luaState, const char* scriptFile)
+// compiles the file and replaces the cached function, a script that fails to compile keeps the
+// function it had so a typo during hot reload doesn't stop the enemies. The modification time of
+// the file is passed in because the shards compile on the workers, which don't call raylib.
+bool CompileLuaScript(lua_State* luaState, LuaScript* script, long modTime)
 {
-    if (!scriptFile)
-        return;
+    script->ModTime = modTime;
+    script->BundleVersion = script->Bundle ? script->Bundle->Version : 0;
 
-    if (luaL_dofile(luaState, scriptFile) == LUA_OK)
+    if (LoadLuaScriptChunk(luaState, script) != LUA_OK)
     {
-        if (lua_pcall(luaState, 0, 0, 0) == LUA_OK)
-        {
-            lua_pop(luaState, lua_gettop(luaState));
-        }
+        ReportScriptError(luaState);
+        return false;
     }
+
+    luaL_unref(luaState, LUA_REGISTRYINDEX, script->FunctionRef);
+    script->FunctionRef = luaL_ref(luaState, LUA_REGISTRYINDEX);
+    return true;
+}
+
+LuaScript LoadLuaScript(lua_State* luaState, const char* scriptFile, const ScriptBundle* bundle)
+{
+    LuaScript script = { scriptFile, bundle, 0, 0, LUA_NOREF };
+    CompileLuaScript(luaState, &script, GetFileModTime(scriptFile));
+    return script;
+}
+
+void UnloadLuaScript(lua_State* luaState, LuaScript* script)
+{
+    luaL_unref(luaState, LUA_REGISTRYINDEX, script->FunctionRef);
+    script->FunctionRef = LUA_NOREF;
+}
+
+// true if the file, with the given modification time, was saved or the bundle was built since
+// the script was compiled
+bool IsLuaScriptChanged(const LuaScript* script, long modTime)
+{
+    int bundleVersion = script->Bundle ? script->Bundle->Version : 0;
+    return modTime != script->ModTime || bundleVersion != script->BundleVersion;
+}
+
+// runs the cached function of the script
+void RunLuaScript(lua_State* luaState, const LuaScript* script)
+{
+    if (script->FunctionRef == LUA_NOREF)
+        return;
+
+    lua_rawgeti(luaState, LUA_REGISTRYINDEX, script->FunctionRef);
+    if (lua_pcall(luaState, 0, 0, 0) != LUA_OK)
+        ReportScriptError(luaState);
 }
 
 Texture PlayerTexture;
@@ -218,15 +364,422 @@ void SetupGame()
     }
 }
 
-void DoEnemyBehaviors(lua_State* luaState)
+// batched view of the enemies: the Enemy table holds one array per field, indexed by the enemy
+// index like the bound functions. Each state fills the arrays of its own enemies, from First to
+// First + Count - 1, once per frame and the scripts read them like any lua table, so reading the
+// state of an enemy doesn't call into C. Scripts write commands for their enemies into the Aim
+// and Fire arrays, they are collected after the scripts ran.
+const char* EnemyViewFields[] = { "PosX", "PosY", "Angle", "Distance", "CanFire", "Aim", "Fire" };
+#define ENEMY_VIEW_FIELD_COUNT (int)(sizeof(EnemyViewFields) / sizeof(EnemyViewFields[0]))
+
+// the coroutine of an enemy, see the scheduler below
+typedef struct
 {
-    for (int i = 0; i < MAX_ENIMIES; i++)
+    lua_State* Thread;
+    // registry reference that keeps the thread from being collected
+    int ThreadRef;
+    double WakeTime;
+}ScriptThread;
+
+// a lua state with its memory, its collector, its script and the behaviors of a range of
+// enemies. Only one thread at a time runs a shard.
+struct ScriptShard
+{
+    lua_State* LuaState;
+    LuaAllocator Allocator;
+    LuaGCScheduler GC;
+    LuaScript Script;
+
+    int FirstEnemy;
+    int EnemyCount;
+
+    // the threads of the enemies of the shard, by enemy index minus FirstEnemy
+    ScriptThread Threads[MAX_ENIMIES];
+    // indices of the sleeping threads, a min heap on the wake time
+    int SleepingThreads[MAX_ENIMIES];
+    int SleepingThreadCount;
+
+    // commands of the last run, applied by the main thread
+    ScriptCommand* Commands;
+    int CommandCount;
+    int CommandCapacity;
+
+    // errors of the last run, logged by the main thread because TraceLog isn't thread safe
+    char Errors[MAX_SCRIPT_ERRORS][MAX_SCRIPT_ERROR_LENGTH];
+    int ErrorCount;
+    int DroppedErrorCount;
+
+    // set by the main thread before the shards run so they don't ask raylib from the workers: the
+    // time of the frame, and whether the script changed and must be compiled again
+    double Time;
+    bool ReloadScript;
+    long ScriptModTime;
+};
+
+ScriptShard ScriptShards[SCRIPT_SHARD_COUNT] = { 0 };
+
+void ReportScriptError(lua_State* luaState)
+{
+    ScriptShard* shard = GetScriptShard(luaState);
+    const char* message = lua_tostring(luaState, -1);
+
+    if (shard->ErrorCount < MAX_SCRIPT_ERRORS)
+        snprintf(shard->Errors[shard->ErrorCount++], MAX_SCRIPT_ERROR_LENGTH, "%s", message ? message : "(error object is not a string)");
+    else
+        shard->DroppedErrorCount++;
+
+    lua_pop(luaState, 1);
+}
+
+void LogScriptErrors(ScriptShard* shard)
+{
+    for (int i = 0; i < shard->ErrorCount; i++)
+        TraceLog(LOG_WARNING, "LUA: %s", shard->Errors[i]);
+
+    if (shard->DroppedErrorCount > 0)
+        TraceLog(LOG_WARNING, "LUA: %d more errors", shard->DroppedErrorCount);
+
+    shard->ErrorCount = 0;
+    shard->DroppedErrorCount = 0;
+}
+
+void PushScriptCommand(ScriptShard* shard, ScriptCommandType type, int enemy, Vector2 value)
+{
+    if (enemy < 0 || enemy >= MAX_ENIMIES)
+        return;
+
+    if (shard->CommandCount == shard->CommandCapacity)
+    {
+        shard->CommandCapacity = shard->CommandCapacity ? shard->CommandCapacity * 2 : 64;
+        shard->Commands = (ScriptCommand*)realloc(shard->Commands, shard->CommandCapacity * sizeof(ScriptCommand));
+    }
+
+    shard->Commands[shard->CommandCount++] = (ScriptCommand){ type, enemy, value };
+}
+
+void PushEnemyView(ScriptShard* shard)
+{
+    lua_State* luaState = shard->LuaState;
+    lua_createtable(luaState, 0, ENEMY_VIEW_FIELD_COUNT + 2);
+
+    lua_pushinteger(luaState, shard->FirstEnemy);
+    lua_setfield(luaState, -2, "First");
+    lua_pushinteger(luaState, shard->EnemyCount);
+    lua_setfield(luaState, -2, "Count");
+
+    for (int i = 0; i < ENEMY_VIEW_FIELD_COUNT; i++)
+    {
+        lua_createtable(luaState, MAX_ENIMIES, 1);
+        lua_setfield(luaState, -2, EnemyViewFields[i]);
+    }
+
+    lua_setglobal(luaState, "Enemy");
+}
+
+// pushes the arrays of the view in the order of EnemyViewFields and returns the stack index of
+// the first one, the caller pops the view and the arrays
+int GetEnemyViewArrays(lua_State* luaState)
+{
+    lua_getglobal(luaState, "Enemy");
+    int first = lua_gettop(luaState) + 1;
+    for (int i = 0; i < ENEMY_VIEW_FIELD_COUNT; i++)
+        lua_getfield(luaState, first - 1, EnemyViewFields[i]);
+    return first;
+}
+
+void RefreshEnemyView(ScriptShard* shard)
+{
+    lua_State* luaState = shard->LuaState;
+    int posX = GetEnemyViewArrays(luaState);
+
+    for (int i = shard->FirstEnemy; i < shard->FirstEnemy + shard->EnemyCount; i++)
+    {
+        lua_pushnumber(luaState, Enemies[i].Position.x);
+        lua_rawseti(luaState, posX, i);
+        lua_pushnumber(luaState, Enemies[i].Position.y);
+        lua_rawseti(luaState, posX + 1, i);
+        lua_pushnumber(luaState, Enemies[i].Angle);
+        lua_rawseti(luaState, posX + 2, i);
+        lua_pushnumber(luaState, Vector2Length(Vector2Subtract(Player.Position, Enemies[i].Position)));
+        lua_rawseti(luaState, posX + 3, i);
+        lua_pushboolean(luaState, Enemies[i].ReloadTime <= 0);
+        lua_rawseti(luaState, posX + 4, i);
+    }
+
+    lua_pop(luaState, ENEMY_VIEW_FIELD_COUNT + 1);
+}
+
+// turns the Aim and Fire arrays of the view into commands and clears them
+void CollectEnemyCommands(ScriptShard* shard)
+{
+    lua_State* luaState = shard->LuaState;
+    int aim = GetEnemyViewArrays(luaState) + 5;
+    int fire = aim + 1;
+
+    for (int i = shard->FirstEnemy; i < shard->FirstEnemy + shard->EnemyCount; i++)
+    {
+        if (lua_rawgeti(luaState, aim, i) != LUA_TNIL)
+        {
+            if (lua_toboolean(luaState, -1))
+                PushScriptCommand(shard, SCRIPT_COMMAND_AIM, i, (Vector2){ 0 });
+
+            lua_pushnil(luaState);
+            lua_rawseti(luaState, aim, i);
+        }
+        lua_pop(luaState, 1);
+
+        if (lua_rawgeti(luaState, fire, i) != LUA_TNIL)
+        {
+            if (lua_isnumber(luaState, -1))
+                PushScriptCommand(shard, SCRIPT_COMMAND_FIRE, i, (Vector2){ (float)lua_tonumber(luaState, -1), 0 });
+
+            lua_pushnil(luaState);
+            lua_rawseti(luaState, fire, i);
+        }
+        lua_pop(luaState, 1);
+    }
+
+    lua_pop(luaState, ENEMY_VIEW_FIELD_COUNT + 1);
+}
+
+// calls UpdateEnemies(Enemy) if the script defines it, a script can handle all enemies of the
+// state in this single call instead of running a behavior per enemy
+void RunEnemyBatchUpdate(lua_State* luaState)
+{
+    if (lua_getglobal(luaState, "UpdateEnemies") != LUA_TFUNCTION)
+    {
+        lua_pop(luaState, 1);
+        return;
+    }
+
+    lua_getglobal(luaState, "Enemy");
+    if (lua_pcall(luaState, 1, 0, 0) != LUA_OK)
+        ReportScriptError(luaState);
+}
+
+// scheduler for the enemy behaviors: each enemy runs the EnemyBehavior function of the script
+// in its own coroutine, which keeps its state in local variables and suspends itself with
+// wait(seconds) or yield(). Sleeping coroutines wait in a heap sorted by wake time, so a frame
+// only touches the coroutines that wake up in it.
+
+void PushSleepingThread(ScriptShard* shard, int index)
+{
+    int position = shard->SleepingThreadCount++;
+    while (position > 0)
+    {
+        int parent = (position - 1) / 2;
+        if (shard->Threads[shard->SleepingThreads[parent]].WakeTime <= shard->Threads[index].WakeTime)
+            break;
+
+        shard->SleepingThreads[position] = shard->SleepingThreads[parent];
+        position = parent;
+    }
+    shard->SleepingThreads[position] = index;
+}
+
+int PopSleepingThread(ScriptShard* shard)
+{
+    int index = shard->SleepingThreads[0];
+    int last = shard->SleepingThreads[--shard->SleepingThreadCount];
+    int position = 0;
+    while (true)
+    {
+        int child = position * 2 + 1;
+        if (child >= shard->SleepingThreadCount)
+            break;
+
+        if (child + 1 < shard->SleepingThreadCount && shard->Threads[shard->SleepingThreads[child + 1]].WakeTime < shard->Threads[shard->SleepingThreads[child]].WakeTime)
+            child++;
+
+        if (shard->Threads[last].WakeTime <= shard->Threads[shard->SleepingThreads[child]].WakeTime)
+            break;
+
+        shard->SleepingThreads[position] = shard->SleepingThreads[child];
+        position = child;
+    }
+    shard->SleepingThreads[position] = last;
+    return index;
+}
+
+void StopEnemyBehaviors(ScriptShard* shard)
+{
+    for (int i = 0; i < shard->EnemyCount; i++)
+    {
+        if (shard->Threads[i].Thread)
+            luaL_unref(shard->LuaState, LUA_REGISTRYINDEX, shard->Threads[i].ThreadRef);
+        shard->Threads[i] = (ScriptThread){ NULL, LUA_NOREF, 0 };
+    }
+    shard->SleepingThreadCount = 0;
+}
+
+// runs the script to define EnemyBehavior and starts a new coroutine for each enemy of the
+// shard if it did, the old coroutines are dropped
+void StartEnemyBehaviors(ScriptShard* shard)
+{
+    lua_State* luaState = shard->LuaState;
+    StopEnemyBehaviors(shard);
+    RunLuaScript(luaState, &shard->Script);
+
+    // scripts that only define UpdateEnemies have no behavior per enemy
+    int behaviorType = lua_getglobal(luaState, "EnemyBehavior");
+    lua_pop(luaState, 1);
+    if (behaviorType != LUA_TFUNCTION)
+        return;
+
+    for (int i = 0; i < shard->EnemyCount; i++)
+    {
+        lua_State* thread = lua_newthread(luaState);
+        shard->Threads[i].Thread = thread;
+        shard->Threads[i].ThreadRef = luaL_ref(luaState, LUA_REGISTRYINDEX);
+        shard->Threads[i].WakeTime = shard->Time;
+
+        // the function and its argument wait on the stack of the thread for the first resume
+        lua_getglobal(thread, "EnemyBehavior");
+        lua_pushinteger(thread, (lua_Integer)(shard->FirstEnemy + i));
+        PushSleepingThread(shard, i);
+    }
+}
+
+// resumes the thread of the enemy and puts it back to sleep if it waits again. Threads that
+// return or fail are released and not resumed anymore.
+void ResumeEnemyBehavior(ScriptShard* shard, int index)
+{
+    ScriptThread* scriptThread = &shard->Threads[index];
+    lua_State* thread = scriptThread->Thread;
+
+    // a thread that didn't start yet has the behavior function and its argument on the stack
+    int argumentCount = lua_status(thread) == LUA_OK ? lua_gettop(thread) - 1 : 0;
+    int resultCount = 0;
+    int status = lua_resume(thread, shard->LuaState, argumentCount, &resultCount);
+
+    if (status == LUA_YIELD)
+    {
+        double seconds = resultCount > 0 ? lua_tonumber(thread, -resultCount) : 0;
+        lua_pop(thread, resultCount);
+        scriptThread->WakeTime = shard->Time + seconds;
+        PushSleepingThread(shard, index);
+        return;
+    }
+
+    if (status != LUA_OK)
+        ReportScriptError(thread);
+
+    luaL_unref(shard->LuaState, LUA_REGISTRYINDEX, scriptThread->ThreadRef);
+    *scriptThread = (ScriptThread){ NULL, LUA_NOREF, 0 };
+}
+
+// creates the lua state of the shard and starts the behaviors of its enemies
+void InitScriptShard(ScriptShard* shard, int firstEnemy, int enemyCount, const char* scriptFile, const ScriptBundle* bundle)
+{
+    shard->FirstEnemy = firstEnemy;
+    shard->EnemyCount = enemyCount;
+
+    // the state takes its memory from the pools of the allocator
+    InitLuaAllocator(&shard->Allocator, SCRIPT_MEMORY_LIMIT);
+    shard->LuaState = NewLuaStateWithAllocator(&shard->Allocator);
+    *(ScriptShard**)lua_getextraspace(shard->LuaState) = shard;
+
+    // the collector only runs after the frames, in generational mode
+    InitLuaGCScheduler(&shard->GC, shard->LuaState, SCRIPT_GC_BUDGET_MICROSECONDS, true);
+    luaL_openlibs(shard->LuaState);
+
+    // push our exposed API functions and the batched view of the enemies into lua
+    PushLuaAPI(shard->LuaState);
+    PushEnemyView(shard);
+
+    // compile the behavior once, it is only compiled again when the file changes
+    shard->Script = LoadLuaScript(shard->LuaState, scriptFile, bundle);
+    StartEnemyBehaviors(shard);
+}
+
+void UnloadScriptShard(ScriptShard* shard)
+{
+    StopEnemyBehaviors(shard);
+    UnloadLuaScript(shard->LuaState, &shard->Script);
+    UnloadLuaGCScheduler(&shard->GC);
+    lua_close(shard->LuaState);
+    UnloadLuaAllocator(&shard->Allocator);
+    free(shard->Commands);
+    *shard = (ScriptShard){ 0 };
+}
+
+// runs the behaviors of a shard that wake up in this frame, called on a worker. The shard only
+// reads the game state and writes to its own commands, so the shards can run at the same time.
+void RunScriptShard(void* data, int index)
+{
+    ScriptShard* shard = &((ScriptShard*)data)[index];
+    lua_State* luaState = shard->LuaState;
+
+    if (shard->ReloadScript && CompileLuaScript(luaState, &shard->Script, shard->ScriptModTime))
+        StartEnemyBehaviors(shard);
+
+    // take all threads that are due before resuming any of them, a thread that yields goes
+    // back to sleep with a wake time of this frame and must not run again before the next one
+    int wakingThreads[MAX_ENIMIES];
+    int wakingThreadCount = 0;
+    while (shard->SleepingThreadCount > 0 && shard->Threads[shard->SleepingThreads[0]].WakeTime <= shard->Time)
+        wakingThreads[wakingThreadCount++] = PopSleepingThread(shard);
+
+    RefreshEnemyView(shard);
+    RunEnemyBatchUpdate(luaState);
+
+    for (int i = 0; i < wakingThreadCount; i++)
+        ResumeEnemyBehavior(shard, wakingThreads[i]);
+
+    CollectEnemyCommands(shard);
+}
+
+void RunScriptShardGC(void* data, int index)
+{
+    RunLuaGCScheduler(&((ScriptShard*)data)[index].GC);
+}
+
+// applies the commands of the shards in the order of the shards and in the order each shard
+// collected them, so the result doesn't depend on which shard finished first
+void ApplyScriptCommands()
+{
+    for (int s = 0; s < SCRIPT_SHARD_COUNT; s++)
     {
-        lua_pushinteger(luaState, (lua_Integer)i);
-        lua_setglobal(luaState, "CurrentEnemy");
+        ScriptShard* shard = &ScriptShards[s];
+        for (int i = 0; i < shard->CommandCount; i++)
+        {
+            ScriptCommand* command = &shard->Commands[i];
+            switch (command->Type)
+            {
+            case SCRIPT_COMMAND_AIM:
+                TurnEnemyTowardPlayer(command->Enemy);
+                break;
+            case SCRIPT_COMMAND_FIRE:
+                FireEnemyBullet(command->Enemy, command->Value.x);
+                break;
+            case SCRIPT_COMMAND_MOVE:
+                Enemies[command->Enemy].Position = command->Value;
+                break;
+            }
+        }
+        shard->CommandCount = 0;
+        LogScriptErrors(shard);
+    }
+}
+
+void DoEnemyBehaviors(ScriptWorkerPool* workers, ScriptBundle* bundle)
+{
+    // a rebuilt bundle is mapped again before the shards run, they reload their scripts from it
+    UpdateScriptBundle(bundle);
 
-        RunLuaScript(luaState, "resources/scripts/enemy_behavior.lua");
+    double time = GetTime();
+    for (int i = 0; i < SCRIPT_SHARD_COUNT; i++)
+    {
+        ScriptShard* shard = &ScriptShards[i];
+        shard->Time = time;
+        shard->ScriptModTime = GetFileModTime(shard->Script.File);
+        shard->ReloadScript = IsLuaScriptChanged(&shard->Script, shard->ScriptModTime);
     }
+
+    RunScriptJobs(workers, RunScriptShard, ScriptShards, SCRIPT_SHARD_COUNT);
+
+    // the sync point: all shards are done and the game state can change again
+    ApplyScriptCommands();
 }
 
 void UpdatePlayer()
@@ -288,6 +841,42 @@ void DoFixedTimeStep(float dt)
 
 }
 
+void DrawScriptStats()
+{
+    for (int i = 0; i < SCRIPT_SHARD_COUNT; i++)
+    {
+        const LuaAllocator* allocator = &ScriptShards[i].Allocator;
+        const LuaGCScheduler* scheduler = &ScriptShards[i].GC;
+        DrawText(TextFormat("lua state %d: memory %.1f KB, peak %.1f KB, fragmentation %.0f%%, gc %.0f us last frame, max pause %.0f us",
+            i, allocator->UsedBytes / 1024.0f, allocator->PeakBytes / 1024.0f, GetLuaAllocatorFragmentation(allocator) * 100,
+            scheduler->LastRunMicroseconds, scheduler->MaxPauseMicroseconds), 10, 10 + i * 25, 20, GRAY);
+    }
+}
+
+void LogScriptMemoryStats(const LuaAllocator* allocator)
+{
+    TraceLog(LOG_INFO, "LUA: memory peak %zu bytes, fragmentation %.1f%%", allocator->PeakBytes, GetLuaAllocatorFragmentation(allocator) * 100);
+    for (int i = 0; i < LUA_ALLOCATOR_CLASS_COUNT; i++)
+    {
+        const LuaAllocatorPool* pool = &allocator->Pools[i];
+        if (pool->PageBytes > 0)
+            TraceLog(LOG_INFO, "LUA:     %3d byte blocks: %zu in use, %zu bytes used of %zu", (i + 1) * LUA_ALLOCATOR_CLASS_STEP, pool->UsedBlocks, pool->UsedBytes, pool->PageBytes);
+    }
+    TraceLog(LOG_INFO, "LUA:     large blocks: %zu in use, %zu bytes", allocator->LargeBlocks, allocator->LargeBytes);
+}
+
+void LogScriptGCStats(const LuaGCScheduler* scheduler)
+{
+    TraceLog(LOG_INFO, "LUA: %d gc steps, max pause %.0f us", scheduler->StepCount, scheduler->MaxPauseMicroseconds);
+    for (int i = 0; i < LUA_GC_HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        if (i < LUA_GC_HISTOGRAM_BUCKET_COUNT - 1)
+            TraceLog(LOG_INFO, "LUA:     pauses below %5d us: %d", LuaGCHistogramLimits[i], scheduler->PauseCounts[i]);
+        else
+            TraceLog(LOG_INFO, "LUA:     longer pauses: %d", scheduler->PauseCounts[i]);
+    }
+}
+
 int main()
 {
     // set up the window
@@ -299,12 +888,21 @@ int main()
 
     SetupGame();
 
-    // setup our lua state/context
-    lua_State* scriptState = luaL_newstate();
-    luaL_openlibs(scriptState);
+    // the scripts precompiled by the lua_bundle tool, if the bundle is missing the scripts are
+    // compiled from source
+    ScriptBundle scriptBundle;
+    if (!LoadScriptBundle(&scriptBundle, "resources/scripts/scripts.luab"))
+        TraceLog(LOG_INFO, "LUA: no script bundle, compiling the scripts from source");
 
-    // push our exposed API functions into lua
-    PushLuaAPI(scriptState);
+    // setup our lua states/contexts, each one gets an equal share of the enemies
+    ScriptWorkerPool* scriptWorkers = CreateScriptWorkerPool(SCRIPT_SHARD_COUNT);
+    for (int i = 0; i < SCRIPT_SHARD_COUNT; i++)
+    {
+        int firstEnemy = MAX_ENIMIES * i / SCRIPT_SHARD_COUNT;
+        int enemyCount = MAX_ENIMIES * (i + 1) / SCRIPT_SHARD_COUNT - firstEnemy;
+        InitScriptShard(&ScriptShards[i], firstEnemy, enemyCount, "resources/scripts/enemy_behavior.lua", &scriptBundle);
+        LogScriptErrors(&ScriptShards[i]);
+    }
 
     float accumulator = 0;
     float fixedTimeStep = 1.0f / 60.0f;
@@ -325,11 +923,23 @@ int main()
 
         UpdateGameState();
 
-        DoEnemyBehaviors(scriptState);
+        DoEnemyBehaviors(scriptWorkers, &scriptBundle);
+        DrawScriptStats();
         EndDrawing();
+
+        // the collectors of the states run at the same time, each within the budget
+        RunScriptJobs(scriptWorkers, RunScriptShardGC, ScriptShards, SCRIPT_SHARD_COUNT);
     }
 
-    lua_close(scriptState);
+    for (int i = 0; i < SCRIPT_SHARD_COUNT; i++)
+    {
+        TraceLog(LOG_INFO, "LUA: state %d", i);
+        LogScriptMemoryStats(&ScriptShards[i].Allocator);
+        LogScriptGCStats(&ScriptShards[i].GC);
+        UnloadScriptShard(&ScriptShards[i]);
+    }
+    DestroyScriptWorkerPool(scriptWorkers);
+    UnloadScriptBundle(&scriptBundle);
 
     // cleanup
     CloseWindow();
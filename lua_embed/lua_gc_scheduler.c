@@ -0,0 +1,127 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C++
+*
+*   lua embed * frame budgeted garbage collection for the lua state
+*
+*   Lua collects garbage whenever the scripts allocated enough to pay a debt, which can be
+*   in the middle of a busy frame. The scheduler stops the automatic collection and runs the
+*   steps itself after the frame is drawn, each call within a time budget. In generational
+*   mode a step is a whole minor collection of the young objects, in incremental mode a cycle
+*   is split into many small steps that may spread over several frames.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "lua_gc_scheduler.h"
+
+#include <string.h>     // Required for: memset
+#include <time.h>       // Required for: timespec_get
+
+// debt in KB added by a step in generational mode, see RunLuaGCScheduler
+#define LUA_GC_GENERATIONAL_STEP_KB 4
+
+const int LuaGCHistogramLimits[LUA_GC_HISTOGRAM_BUCKET_COUNT - 1] = { 50, 100, 250, 500, 1000, 2000, 5000 };
+
+static double GetMicroseconds(void)
+{
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return time.tv_sec * 1000000.0 + time.tv_nsec / 1000.0;
+}
+
+static void RecordPause(LuaGCScheduler* scheduler, double microseconds)
+{
+    int bucket = 0;
+    while (bucket < LUA_GC_HISTOGRAM_BUCKET_COUNT - 1 && microseconds >= LuaGCHistogramLimits[bucket])
+        bucket++;
+
+    scheduler->PauseCounts[bucket]++;
+    scheduler->StepCount++;
+    scheduler->TotalPauseMicroseconds += microseconds;
+    if (microseconds > scheduler->MaxPauseMicroseconds)
+        scheduler->MaxPauseMicroseconds = microseconds;
+}
+
+void InitLuaGCScheduler(LuaGCScheduler* scheduler, lua_State* luaState, int budgetMicroseconds, bool generational)
+{
+    memset(scheduler, 0, sizeof(LuaGCScheduler));
+    scheduler->LuaState = luaState;
+    scheduler->BudgetMicroseconds = budgetMicroseconds;
+    scheduler->Generational = generational;
+
+    // the same growth lua waits for with its default parameters
+    scheduler->GrowthPercent = generational ? 20 : 100;
+
+    lua_gc(luaState, generational ? LUA_GCGEN : LUA_GCINC, 0, 0);
+    lua_gc(luaState, LUA_GCSTOP);
+    scheduler->CollectedKB = lua_gc(luaState, LUA_GCCOUNT);
+}
+
+void UnloadLuaGCScheduler(LuaGCScheduler* scheduler)
+{
+    lua_gc(scheduler->LuaState, LUA_GCRESTART);
+}
+
+void RunLuaGCScheduler(LuaGCScheduler* scheduler)
+{
+    lua_State* luaState = scheduler->LuaState;
+    double start = GetMicroseconds();
+    double now = start;
+
+    while (true)
+    {
+        int usedKB = lua_gc(luaState, LUA_GCCOUNT);
+        bool grown = usedKB > scheduler->CollectedKB + scheduler->CollectedKB * scheduler->GrowthPercent / 100;
+        if (!scheduler->CycleRunning && !grown)
+            break;
+
+        double averagePause = scheduler->StepCount > 0 ? scheduler->TotalPauseMicroseconds / scheduler->StepCount : 0;
+        if (now > start && now - start + averagePause > scheduler->BudgetMicroseconds)
+            break;
+
+        // a step runs even though the collector is stopped. A basic step (size 0) clears the
+        // debt, but a generational step only starts a major collection when there is debt, so
+        // in generational mode the step adds some: the stopped collector keeps the debt above
+        // -2000 bytes, so a debt of 4 KB is always positive.
+        int cycleDone = lua_gc(luaState, LUA_GCSTEP, scheduler->Generational ? LUA_GC_GENERATIONAL_STEP_KB : 0);
+
+        double stepEnd = GetMicroseconds();
+        RecordPause(scheduler, stepEnd - now);
+        now = stepEnd;
+
+        // generational steps are whole collections, incremental ones run until the cycle ends
+        if (scheduler->Generational || cycleDone)
+        {
+            scheduler->CycleRunning = false;
+            scheduler->CollectedKB = lua_gc(luaState, LUA_GCCOUNT);
+        }
+        else
+        {
+            scheduler->CycleRunning = true;
+        }
+    }
+
+    scheduler->LastRunMicroseconds = now - start;
+}
@@ -0,0 +1,58 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C++
+*
+*   lua embed * frame budgeted garbage collection for the lua state
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+**********************************************************************************************/
+
+#ifndef LUA_GC_SCHEDULER_H
+#define LUA_GC_SCHEDULER_H
+
+#include <stdbool.h>
+
+#include "lua.h"
+
+// upper limits of the pause histogram buckets in microseconds, the last bucket has no limit
+#define LUA_GC_HISTOGRAM_BUCKET_COUNT 8
+extern const int LuaGCHistogramLimits[LUA_GC_HISTOGRAM_BUCKET_COUNT - 1];
+
+// runs the collector of a lua state only when the game calls it, in the time left after a
+// frame, so collections don't happen in the middle of the scripts. The automatic collector of
+// the state is stopped; a memory error still makes lua run a full emergency collection.
+typedef struct
+{
+    lua_State* LuaState;
+    int BudgetMicroseconds;
+    bool Generational;
+    // a new cycle (incremental mode) or minor collection (generational mode) only starts when
+    // the memory in use grew by this share since the last one ended
+    int GrowthPercent;
+    int CollectedKB;
+    // an incremental cycle was started and is not finished yet
+    bool CycleRunning;
+
+    // number of collector steps by the time they took
+    int PauseCounts[LUA_GC_HISTOGRAM_BUCKET_COUNT];
+    int StepCount;
+    double TotalPauseMicroseconds;
+    double MaxPauseMicroseconds;
+    // time the collector took in the last call of RunLuaGCScheduler
+    double LastRunMicroseconds;
+}LuaGCScheduler;
+
+// puts the collector into generational or incremental mode and stops the automatic collection
+void InitLuaGCScheduler(LuaGCScheduler* scheduler, lua_State* luaState, int budgetMicroseconds, bool generational);
+// gives the collection back to lua
+void UnloadLuaGCScheduler(LuaGCScheduler* scheduler);
+
+// runs collector steps until the budget is used up or there is nothing left to collect. A step
+// that is expected to take longer than the rest of the budget is not started, except for the
+// first step of a call, so the collector keeps up even if its steps are longer than the budget.
+void RunLuaGCScheduler(LuaGCScheduler* scheduler);
+
+#endif
@@ -37,6 +37,23 @@ baseName = path.getbasename(os.getcwd())
 		files {"lua/src/*.h", "lua/src/*.c"}
 
     includedirs { "lua/src" }
+
+	-- build tool that precompiles the scripts into a bundle of stripped bytecode
+	project('lua_bundle')
+		kind "ConsoleApp"
+		location "_build"
+		targetdir "_bin/%{cfg.buildcfg}"
+
+		files {"tools/lua_bundle.c", "script_bundle.h"}
+
+		includedirs { "./"}
+		includedirs { "lua/src"}
+		links('lua')
+
+		filter "system:linux"
+			links {"m"}
+
+		filter{}
 		
     project (baseName)
         kind "ConsoleApp"
@@ -62,4 +79,10 @@ baseName = path.getbasename(os.getcwd())
         includedirs { "./"}
 		includedirs { "lua/src"}
 		links('lua')
+
+		-- the scripts are compiled into resources/scripts/scripts.luab before each build, the
+		-- game loads them from there and only parses scripts that were edited since
+		dependson('lua_bundle')
+		prebuildcommands { 'cd "%{wks.location}" && "%{cfg.targetdir}/lua_bundle" resources/scripts/scripts.luab ' .. table.concat(os.matchfiles("resources/scripts/*.lua"), " ") }
+
         link_raylib();
\ No newline at end of file
@@ -1,10 +1,20 @@
 -- simple lua scripts
 math.randomseed(os.time())
 
-distance = DistanceToPlayer(CurrentEnemy)
-if (distance <= (300 + math.random(100,200))) then
-	aimOk = TurnTowardPlayer(CurrentEnemy, 90)
-	if (aimOk and EnemyCanFire(CurrentEnemy)) then
-		EnemyFire(CurrentEnemy, 300 + math.random(100,200))
+-- runs as a coroutine for each enemy, the local variables keep their values between frames.
+-- The state of the enemies is read from the Enemy arrays and the commands are written back to
+-- them, the host applies them after all behaviors ran.
+function EnemyBehavior(enemy)
+	while true do
+		if (Enemy.Distance[enemy] <= (300 + math.random(100,200))) then
+			Enemy.Aim[enemy] = true
+			if (Enemy.CanFire[enemy]) then
+				Enemy.Fire[enemy] = 300 + math.random(100,200)
+			end
+			yield()
+		else
+			-- the player is out of range, look again later
+			wait(0.25)
+		end
 	end
-end
\ No newline at end of file
+end
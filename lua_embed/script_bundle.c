@@ -0,0 +1,248 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C++
+*
+*   lua embed * memory mapped bundle of precompiled scripts
+*
+*   The lua_bundle tool compiles the scripts at build time and writes their stripped bytecode
+*   into one file. The game maps that file into memory and hands each chunk to lua_load with
+*   a reader that returns the whole chunk at once, so loading a script neither reads the file
+*   into a buffer nor runs the lexer and parser.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "script_bundle.h"
+
+#include <stdio.h>      // Required for: snprintf
+#include <stdlib.h>     // Required for: malloc, free
+#include <string.h>     // Required for: memset, memcmp, strlen
+#include <sys/stat.h>   // Required for: stat
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #include <windows.h>
+#else
+    #include <fcntl.h>      // Required for: open
+    #include <sys/mman.h>   // Required for: mmap, munmap
+    #include <unistd.h>     // Required for: close
+#endif
+
+typedef struct
+{
+    long ModTime;
+    long long FileSize;
+    unsigned long long FileIndex;
+}BundleFileStamp;
+
+static BundleFileStamp GetBundleFileStamp(const char* file)
+{
+    BundleFileStamp stamp = { 0 };
+    struct stat info;
+    if (stat(file, &info) == 0)
+    {
+        stamp.ModTime = (long)info.st_mtime;
+        stamp.FileSize = (long long)info.st_size;
+        stamp.FileIndex = (unsigned long long)info.st_ino;
+    }
+    return stamp;
+}
+
+static bool MapBundleFile(ScriptBundle* bundle, const char* file)
+{
+#if defined(_WIN32)
+    // Windows doesn't let a file with a mapped view be replaced, whatever the share mode, so
+    // the bundle is read into memory and the file is closed again. Sharing delete access lets
+    // the lua_bundle tool replace the file during the read.
+    HANDLE fileHandle = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    unsigned char* data = NULL;
+    DWORD readSize = 0;
+    if (GetFileSizeEx(fileHandle, &size) && size.QuadPart > 0 && size.QuadPart <= MAXDWORD)
+        data = (unsigned char*)malloc((size_t)size.QuadPart);
+
+    bool read = data && ReadFile(fileHandle, data, (DWORD)size.QuadPart, &readSize, NULL) && readSize == (DWORD)size.QuadPart;
+    CloseHandle(fileHandle);
+    if (!read)
+    {
+        free(data);
+        return false;
+    }
+
+    bundle->Data = data;
+    bundle->Size = (size_t)size.QuadPart;
+#else
+    int fileHandle = open(file, O_RDONLY);
+    if (fileHandle < 0)
+        return false;
+
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(fileHandle, &info) == 0 && info.st_size > 0)
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fileHandle, 0);
+
+    // the mapping stays valid after the file is closed
+    close(fileHandle);
+    if (data == MAP_FAILED)
+        return false;
+
+    bundle->Data = data;
+    bundle->Size = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+static void UnmapBundleFile(ScriptBundle* bundle)
+{
+    if (!bundle->Data)
+        return;
+
+#if defined(_WIN32)
+    free((void*)bundle->Data);
+#else
+    munmap((void*)bundle->Data, bundle->Size);
+#endif
+}
+
+// checks that the header, the entries, the names and the chunks are all inside the file
+static bool IsValidBundle(const ScriptBundle* bundle)
+{
+    if (bundle->Size < sizeof(ScriptBundleHeader))
+        return false;
+
+    const ScriptBundleHeader* header = (const ScriptBundleHeader*)bundle->Data;
+    if (memcmp(header->Magic, SCRIPT_BUNDLE_MAGIC, 4) != 0 || header->Version != SCRIPT_BUNDLE_VERSION)
+        return false;
+
+    if (header->ChunkCount > (bundle->Size - sizeof(ScriptBundleHeader)) / sizeof(ScriptBundleEntry))
+        return false;
+
+    const ScriptBundleEntry* entries = (const ScriptBundleEntry*)(header + 1);
+    for (uint32_t i = 0; i < header->ChunkCount; i++)
+    {
+        if (entries[i].NameOffset > bundle->Size || entries[i].NameLength > bundle->Size - entries[i].NameOffset)
+            return false;
+        if (entries[i].DataOffset > bundle->Size || entries[i].DataSize > bundle->Size - entries[i].DataOffset)
+            return false;
+    }
+    return true;
+}
+
+bool LoadScriptBundle(ScriptBundle* bundle, const char* file)
+{
+    memset(bundle, 0, sizeof(ScriptBundle));
+    bundle->File = file;
+    BundleFileStamp stamp = GetBundleFileStamp(file);
+    bundle->ModTime = stamp.ModTime;
+    bundle->FileSize = stamp.FileSize;
+    bundle->FileIndex = stamp.FileIndex;
+
+    if (!MapBundleFile(bundle, file))
+        return false;
+
+    if (!IsValidBundle(bundle))
+    {
+        UnmapBundleFile(bundle);
+        bundle->Data = NULL;
+        bundle->Size = 0;
+        return false;
+    }
+
+    const ScriptBundleHeader* header = (const ScriptBundleHeader*)bundle->Data;
+    bundle->Entries = (const ScriptBundleEntry*)(header + 1);
+    bundle->ChunkCount = (int)header->ChunkCount;
+    return true;
+}
+
+void UnloadScriptBundle(ScriptBundle* bundle)
+{
+    UnmapBundleFile(bundle);
+    const char* file = bundle->File;
+    int version = bundle->Version;
+    memset(bundle, 0, sizeof(ScriptBundle));
+    bundle->File = file;
+    bundle->Version = version;
+}
+
+bool UpdateScriptBundle(ScriptBundle* bundle)
+{
+    if (!bundle->File)
+        return false;
+
+    BundleFileStamp stamp = GetBundleFileStamp(bundle->File);
+    if (stamp.ModTime == bundle->ModTime && stamp.FileSize == bundle->FileSize && stamp.FileIndex == bundle->FileIndex)
+        return false;
+
+    const char* file = bundle->File;
+    int version = bundle->Version;
+    UnloadScriptBundle(bundle);
+    LoadScriptBundle(bundle, file);
+    bundle->Version = version + 1;
+    return true;
+}
+
+const ScriptBundleEntry* FindScriptBundleChunk(const ScriptBundle* bundle, const char* name)
+{
+    size_t length = strlen(name);
+    for (int i = 0; i < bundle->ChunkCount; i++)
+    {
+        const ScriptBundleEntry* entry = &bundle->Entries[i];
+        if (entry->NameLength == length && memcmp(bundle->Data + entry->NameOffset, name, length) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+typedef struct
+{
+    const unsigned char* Data;
+    size_t Size;
+}ChunkReader;
+
+// returns the whole chunk on the first call and nothing afterwards
+static const char* ReadChunk(lua_State* luaState, void* data, size_t* size)
+{
+    (void)luaState;
+    ChunkReader* reader = (ChunkReader*)data;
+    *size = reader->Size;
+    reader->Size = 0;
+    return *size > 0 ? (const char*)reader->Data : NULL;
+}
+
+int LoadScriptBundleChunk(lua_State* luaState, const ScriptBundle* bundle, const ScriptBundleEntry* entry)
+{
+    ChunkReader reader = { bundle->Data + entry->DataOffset, entry->DataSize };
+
+    // the chunk name is shown in errors, stripped chunks have no source name of their own
+    char chunkName[256];
+    snprintf(chunkName, sizeof(chunkName), "@%.*s", (int)entry->NameLength, (const char*)bundle->Data + entry->NameOffset);
+
+    // binary chunks only, a bundle never contains source text
+    return lua_load(luaState, ReadChunk, &reader, chunkName, "b");
+}
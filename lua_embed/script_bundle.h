@@ -0,0 +1,78 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C++
+*
+*   lua embed * memory mapped bundle of precompiled scripts
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+**********************************************************************************************/
+
+#ifndef SCRIPT_BUNDLE_H
+#define SCRIPT_BUNDLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lua.h"
+
+// a bundle starts with the magic, the version and the number of chunks, followed by an entry
+// per chunk. The offsets of the entries count from the start of the file.
+#define SCRIPT_BUNDLE_MAGIC "LUAB"
+#define SCRIPT_BUNDLE_VERSION 1
+
+typedef struct
+{
+    char Magic[4];
+    uint32_t Version;
+    uint32_t ChunkCount;
+}ScriptBundleHeader;
+
+typedef struct
+{
+    // name of the script the chunk was compiled from, without terminating zero
+    uint32_t NameOffset;
+    uint32_t NameLength;
+    // the stripped bytecode of lua_dump
+    uint32_t DataOffset;
+    uint32_t DataSize;
+}ScriptBundleEntry;
+
+typedef struct
+{
+    const char* File;
+    // modification time, size and file index (the inode, 0 on Windows) of the file when it was
+    // mapped. The modification time only counts seconds, a new bundle written in the same second
+    // still has another size or index because the tool replaces the file instead of writing it.
+    long ModTime;
+    long long FileSize;
+    unsigned long long FileIndex;
+    // incremented each time the file is mapped again, scripts compare it to notice a new bundle
+    int Version;
+    const unsigned char* Data;
+    size_t Size;
+    const ScriptBundleEntry* Entries;
+    int ChunkCount;
+}ScriptBundle;
+
+// maps the bundle file into memory, on Windows it is read into memory instead so the file can
+// be replaced while the game runs. Returns false and leaves the bundle empty if the file is
+// missing or not a valid bundle
+bool LoadScriptBundle(ScriptBundle* bundle, const char* file);
+void UnloadScriptBundle(ScriptBundle* bundle);
+
+// maps the file again if it was replaced since it was mapped, returns true if it was. The chunks
+// loaded from the old mapping stay valid, lua copies everything it needs while loading.
+bool UpdateScriptBundle(ScriptBundle* bundle);
+
+// the entry of the chunk compiled from the given script, NULL if the bundle has none
+const ScriptBundleEntry* FindScriptBundleChunk(const ScriptBundle* bundle, const char* name);
+
+// loads the chunk as a function onto the stack like luaL_loadfile. Lua reads the bytecode
+// straight from the bundle's memory, nothing is copied or parsed.
+int LoadScriptBundleChunk(lua_State* luaState, const ScriptBundle* bundle, const ScriptBundleEntry* entry);
+
+#endif
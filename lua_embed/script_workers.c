@@ -0,0 +1,208 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C++
+*
+*   lua embed * worker threads for the script states
+*
+*   The worker threads are started once and wait for runs. The indices of a run are handed
+*   out one at a time, so a thread that finishes a short job early picks up the next one, and
+*   the thread that started the run works on them too instead of just waiting.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "script_workers.h"
+
+#include <stdbool.h>    // Required for: bool
+#include <stdlib.h>     // Required for: malloc, calloc, free
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #include <windows.h>
+    typedef HANDLE WorkerThread;
+    typedef CRITICAL_SECTION WorkerMutex;
+    typedef CONDITION_VARIABLE WorkerCondition;
+    #define InitWorkerMutex(m) InitializeCriticalSection(m)
+    #define DestroyWorkerMutex(m) DeleteCriticalSection(m)
+    #define LockWorkerMutex(m) EnterCriticalSection(m)
+    #define UnlockWorkerMutex(m) LeaveCriticalSection(m)
+    #define InitWorkerCondition(c) InitializeConditionVariable(c)
+    #define DestroyWorkerCondition(c)
+    #define WaitWorkerCondition(c, m) SleepConditionVariableCS(c, m, INFINITE)
+    #define BroadcastWorkerCondition(c) WakeAllConditionVariable(c)
+#else
+    #include <pthread.h>
+    typedef pthread_t WorkerThread;
+    typedef pthread_mutex_t WorkerMutex;
+    typedef pthread_cond_t WorkerCondition;
+    #define InitWorkerMutex(m) pthread_mutex_init(m, NULL)
+    #define DestroyWorkerMutex(m) pthread_mutex_destroy(m)
+    #define LockWorkerMutex(m) pthread_mutex_lock(m)
+    #define UnlockWorkerMutex(m) pthread_mutex_unlock(m)
+    #define InitWorkerCondition(c) pthread_cond_init(c, NULL)
+    #define DestroyWorkerCondition(c) pthread_cond_destroy(c)
+    #define WaitWorkerCondition(c, m) pthread_cond_wait(c, m)
+    #define BroadcastWorkerCondition(c) pthread_cond_broadcast(c)
+#endif
+
+struct ScriptWorkerPool
+{
+    WorkerThread* Threads;
+    int WorkerCount;
+    WorkerMutex Mutex;
+    // signaled when a new run starts or the pool shuts down
+    WorkerCondition RunStarted;
+    // signaled when the last job of a run is done
+    WorkerCondition RunDone;
+    int RunId;
+    int Shutdown;
+
+    // the current run
+    ScriptJob Job;
+    void* Data;
+    int JobCount;
+    int NextJob;
+    int PendingCount;
+};
+
+// calls jobs of the current run until none are left, called with the mutex locked
+static void RunPendingJobs(ScriptWorkerPool* pool)
+{
+    while (pool->NextJob < pool->JobCount)
+    {
+        int index = pool->NextJob++;
+        ScriptJob job = pool->Job;
+        void* data = pool->Data;
+        UnlockWorkerMutex(&pool->Mutex);
+
+        job(data, index);
+
+        LockWorkerMutex(&pool->Mutex);
+        pool->PendingCount--;
+        if (pool->PendingCount == 0)
+            BroadcastWorkerCondition(&pool->RunDone);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI WorkerMain(LPVOID data)
+#else
+static void* WorkerMain(void* data)
+#endif
+{
+    ScriptWorkerPool* pool = (ScriptWorkerPool*)data;
+    int lastRunId = 0;
+    LockWorkerMutex(&pool->Mutex);
+    while (true)
+    {
+        while (!pool->Shutdown && pool->RunId == lastRunId)
+            WaitWorkerCondition(&pool->RunStarted, &pool->Mutex);
+
+        if (pool->Shutdown)
+            break;
+
+        lastRunId = pool->RunId;
+        RunPendingJobs(pool);
+    }
+    UnlockWorkerMutex(&pool->Mutex);
+    return 0;
+}
+
+static bool StartWorkerThread(ScriptWorkerPool* pool, WorkerThread* thread)
+{
+#if defined(_WIN32)
+    *thread = CreateThread(NULL, 0, WorkerMain, pool, 0, NULL);
+    return *thread != NULL;
+#else
+    return pthread_create(thread, NULL, WorkerMain, pool) == 0;
+#endif
+}
+
+ScriptWorkerPool* CreateScriptWorkerPool(int threadCount)
+{
+    ScriptWorkerPool* pool = (ScriptWorkerPool*)calloc(1, sizeof(ScriptWorkerPool));
+    InitWorkerMutex(&pool->Mutex);
+    InitWorkerCondition(&pool->RunStarted);
+    InitWorkerCondition(&pool->RunDone);
+
+    // the calling thread runs jobs too, so one thread less is started. If a thread can't be
+    // started the pool keeps the ones it has, with none the caller runs all jobs itself.
+    int workerCount = threadCount > 1 ? threadCount - 1 : 0;
+    pool->Threads = (WorkerThread*)malloc(workerCount * sizeof(WorkerThread));
+    while (pool->WorkerCount < workerCount && StartWorkerThread(pool, &pool->Threads[pool->WorkerCount]))
+        pool->WorkerCount++;
+
+    return pool;
+}
+
+void DestroyScriptWorkerPool(ScriptWorkerPool* pool)
+{
+    LockWorkerMutex(&pool->Mutex);
+    pool->Shutdown = 1;
+    BroadcastWorkerCondition(&pool->RunStarted);
+    UnlockWorkerMutex(&pool->Mutex);
+
+    for (int i = 0; i < pool->WorkerCount; i++)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(pool->Threads[i], INFINITE);
+        CloseHandle(pool->Threads[i]);
+#else
+        pthread_join(pool->Threads[i], NULL);
+#endif
+    }
+
+    DestroyWorkerCondition(&pool->RunStarted);
+    DestroyWorkerCondition(&pool->RunDone);
+    DestroyWorkerMutex(&pool->Mutex);
+    free(pool->Threads);
+    free(pool);
+}
+
+void RunScriptJobs(ScriptWorkerPool* pool, ScriptJob job, void* data, int jobCount)
+{
+    if (jobCount <= 0)
+        return;
+
+    LockWorkerMutex(&pool->Mutex);
+    pool->Job = job;
+    pool->Data = data;
+    pool->JobCount = jobCount;
+    pool->NextJob = 0;
+    pool->PendingCount = jobCount;
+    pool->RunId++;
+    BroadcastWorkerCondition(&pool->RunStarted);
+
+    // the calling thread helps out instead of just waiting
+    RunPendingJobs(pool);
+    while (pool->PendingCount > 0)
+        WaitWorkerCondition(&pool->RunDone, &pool->Mutex);
+
+    pool->Job = NULL;
+    pool->Data = NULL;
+    pool->JobCount = 0;
+    UnlockWorkerMutex(&pool->Mutex);
+}
@@ -0,0 +1,30 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C++
+*
+*   lua embed * worker threads for the script states
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+**********************************************************************************************/
+
+#ifndef SCRIPT_WORKERS_H
+#define SCRIPT_WORKERS_H
+
+typedef struct ScriptWorkerPool ScriptWorkerPool;
+
+// a job is called once for each index of a run, the calls of a run may be on different threads
+typedef void (*ScriptJob)(void* data, int index);
+
+// starts threadCount - 1 worker threads, the thread that runs the jobs is the last one
+ScriptWorkerPool* CreateScriptWorkerPool(int threadCount);
+void DestroyScriptWorkerPool(ScriptWorkerPool* pool);
+
+// calls the job for the indices 0 to jobCount - 1 on the workers and the calling thread and
+// returns when all calls are done. Each index is handed out once, so a job only needs to be
+// thread safe with respect to the other indices.
+void RunScriptJobs(ScriptWorkerPool* pool, ScriptJob job, void* data, int jobCount);
+
+#endif
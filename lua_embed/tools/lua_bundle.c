@@ -0,0 +1,187 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C++
+*
+*   lua embed * build tool that precompiles the scripts into a bundle
+*
+*   usage: lua_bundle <bundle file> <script files...>
+*
+*   Compiles each script like luac, strips the debug information and writes the chunks into
+*   one bundle that the game maps into memory (see script_bundle.h). The scripts are stored
+*   under the names given on the command line, the game looks them up by the same paths it
+*   would load the source from.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#endif
+
+#include "lua.h"
+#include "lauxlib.h"
+
+#include "script_bundle.h"
+
+typedef struct
+{
+    unsigned char* Data;
+    size_t Size;
+    size_t Capacity;
+}Buffer;
+
+bool AppendBuffer(Buffer* buffer, const void* data, size_t size)
+{
+    if (buffer->Size + size > buffer->Capacity)
+    {
+        size_t capacity = buffer->Capacity ? buffer->Capacity : 4096;
+        while (buffer->Size + size > capacity)
+            capacity *= 2;
+
+        unsigned char* grown = (unsigned char*)realloc(buffer->Data, capacity);
+        if (!grown)
+            return false;
+
+        buffer->Data = grown;
+        buffer->Capacity = capacity;
+    }
+
+    memcpy(buffer->Data + buffer->Size, data, size);
+    buffer->Size += size;
+    return true;
+}
+
+// the lua_Writer of lua_dump, a nonzero result stops the dump
+int WriteChunk(lua_State* luaState, const void* data, size_t size, void* userData)
+{
+    (void)luaState;
+    return AppendBuffer((Buffer*)userData, data, size) ? 0 : 1;
+}
+
+bool WriteFile(FILE* file, const void* data, size_t size)
+{
+    return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+// moves the new bundle over the old one. The game may have the old bundle mapped, so it is never
+// truncated or written in place: a rename replaces it at once and the game either sees the old
+// or the new file, never a half written one.
+bool ReplaceBundle(const char* tempFile, const char* bundleFile)
+{
+#if defined(_WIN32)
+    // a file with a mapped view can't be replaced on Windows, so the game reads the bundle
+    // into memory there and only keeps it open, with FILE_SHARE_DELETE, during the read
+    return MoveFileExA(tempFile, bundleFile, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(tempFile, bundleFile) == 0;
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <bundle file> <script files...>\n", argv[0]);
+        return 1;
+    }
+
+    int chunkCount = argc - 2;
+    ScriptBundleEntry* entries = (ScriptBundleEntry*)calloc(chunkCount, sizeof(ScriptBundleEntry));
+
+    // the names and the chunks are collected first, their offsets are known once the size of the
+    // header and the entries is added
+    Buffer names = { 0 };
+    Buffer chunks = { 0 };
+
+    lua_State* luaState = luaL_newstate();
+    for (int i = 0; i < chunkCount; i++)
+    {
+        const char* file = argv[i + 2];
+        if (luaL_loadfile(luaState, file) != LUA_OK)
+        {
+            fprintf(stderr, "%s\n", lua_tostring(luaState, -1));
+            return 1;
+        }
+
+        entries[i].NameOffset = (uint32_t)names.Size;
+        entries[i].NameLength = (uint32_t)strlen(file);
+        entries[i].DataOffset = (uint32_t)chunks.Size;
+        if (!AppendBuffer(&names, file, strlen(file)) || lua_dump(luaState, WriteChunk, &chunks, 1) != 0)
+        {
+            fprintf(stderr, "out of memory while compiling %s\n", file);
+            return 1;
+        }
+        entries[i].DataSize = (uint32_t)(chunks.Size - entries[i].DataOffset);
+        lua_pop(luaState, 1);
+    }
+    lua_close(luaState);
+
+    ScriptBundleHeader header = { { 0 }, SCRIPT_BUNDLE_VERSION, (uint32_t)chunkCount };
+    memcpy(header.Magic, SCRIPT_BUNDLE_MAGIC, 4);
+
+    uint32_t namesOffset = (uint32_t)(sizeof(header) + chunkCount * sizeof(ScriptBundleEntry));
+    uint32_t chunksOffset = namesOffset + (uint32_t)names.Size;
+    for (int i = 0; i < chunkCount; i++)
+    {
+        entries[i].NameOffset += namesOffset;
+        entries[i].DataOffset += chunksOffset;
+    }
+
+    // the bundle is written next to the old one and then moved over it
+    char tempFile[4096];
+    snprintf(tempFile, sizeof(tempFile), "%s.tmp", argv[1]);
+
+    FILE* bundleFile = fopen(tempFile, "wb");
+    if (!bundleFile)
+    {
+        fprintf(stderr, "can't write %s\n", tempFile);
+        return 1;
+    }
+
+    bool written = WriteFile(bundleFile, &header, sizeof(header));
+    written = written && WriteFile(bundleFile, entries, chunkCount * sizeof(ScriptBundleEntry));
+    written = written && WriteFile(bundleFile, names.Data, names.Size);
+    written = written && WriteFile(bundleFile, chunks.Data, chunks.Size);
+    written = fclose(bundleFile) == 0 && written;
+
+    if (!written || !ReplaceBundle(tempFile, argv[1]))
+    {
+        fprintf(stderr, "can't write %s\n", argv[1]);
+        remove(tempFile);
+        return 1;
+    }
+
+    printf("%s: %d scripts, %zu bytes of bytecode\n", argv[1], chunkCount, chunks.Size);
+
+    free(entries);
+    free(names.Data);
+    free(chunks.Data);
+    return 0;
+}
@@ -0,0 +1,214 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - benchmark maps
+*
+*   Seeded maps for the benchmarks: random blocks like the example generates, mazes where
+*   the paths are long and the SDF is small everywhere, open fields where the searches
+*   can jump, and outdoor maps where most cells are far from any wall. The generators only
+*   use their own random state, the same seed gives the same map on every platform and at
+*   every size.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "benchmark_maps.h"
+
+#include <stdlib.h> // Required for: malloc, free
+
+int BenchmarkRandomValue(unsigned int *state, int min, int max)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return min + (int)(*state % (unsigned int)(max - min + 1));
+}
+
+static void GenerateRandomBlocks(PathGrid *grid, unsigned int *state)
+{
+    int blockCount = 40 * grid->width * grid->height / (80 * 45);
+    for (int i = 0; i < blockCount; i++)
+    {
+        int x = BenchmarkRandomValue(state, 15, grid->width-15);
+        int y = BenchmarkRandomValue(state, 15, grid->height-15);
+        int size = BenchmarkRandomValue(state, 1, 2);
+        int blockValue = BenchmarkRandomValue(state, 0, 1);
+        for (int j=-size;j<=size;j++)
+        {
+            for (int k=-size;k<=size;k++)
+            {
+                grid->blockedCells[(y+j)*grid->width + x+k] = blockValue;
+            }
+        }
+    }
+}
+
+// corridors of 3 cells with walls of 1 cell between them, carved by a depth first walk
+#define MAZE_CORRIDOR_WIDTH 3
+#define MAZE_PITCH (MAZE_CORRIDOR_WIDTH + 1)
+
+static void CarveMazeRect(PathGrid *grid, int x, int y, int width, int height)
+{
+    for (int j = y; j < y + height; j++)
+    {
+        for (int i = x; i < x + width; i++)
+        {
+            grid->blockedCells[j * grid->width + i] = 0;
+        }
+    }
+}
+
+static void GenerateMaze(PathGrid *grid, unsigned int *state)
+{
+    int mazeWidth = (grid->width - 1) / MAZE_PITCH;
+    int mazeHeight = (grid->height - 1) / MAZE_PITCH;
+    for (int i = 0; i < grid->width * grid->height; i++)
+    {
+        grid->blockedCells[i] = 1;
+    }
+    if (mazeWidth == 0 || mazeHeight == 0)
+    {
+        return;
+    }
+
+    // the walk uses its own stack, a recursion would be as deep as the maze is long
+    int *stack = (int*)malloc(sizeof(int) * mazeWidth * mazeHeight);
+    unsigned char *visited = (unsigned char*)calloc(mazeWidth * mazeHeight, 1);
+    int stackCount = 0;
+    stack[stackCount++] = 0;
+    visited[0] = 1;
+    CarveMazeRect(grid, 1, 1, MAZE_CORRIDOR_WIDTH, MAZE_CORRIDOR_WIDTH);
+    while (stackCount > 0)
+    {
+        int cell = stack[stackCount - 1];
+        int x = cell % mazeWidth;
+        int y = cell / mazeWidth;
+        int options[4];
+        int optionCount = 0;
+        const int directions[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+        for (int i = 0; i < 4; i++)
+        {
+            int nextX = x + directions[i][0];
+            int nextY = y + directions[i][1];
+            if (nextX >= 0 && nextX < mazeWidth && nextY >= 0 && nextY < mazeHeight && !visited[nextY * mazeWidth + nextX])
+            {
+                options[optionCount++] = nextY * mazeWidth + nextX;
+            }
+        }
+        if (optionCount == 0)
+        {
+            stackCount--;
+            continue;
+        }
+
+        int next = options[BenchmarkRandomValue(state, 0, optionCount - 1)];
+        int nextX = next % mazeWidth;
+        int nextY = next / mazeWidth;
+        // the rectangle covers both corridor cells and the wall between them
+        int minX = nextX < x ? nextX : x;
+        int minY = nextY < y ? nextY : y;
+        CarveMazeRect(grid, 1 + minX * MAZE_PITCH, 1 + minY * MAZE_PITCH,
+            MAZE_CORRIDOR_WIDTH + (nextX != x) * MAZE_PITCH, MAZE_CORRIDOR_WIDTH + (nextY != y) * MAZE_PITCH);
+        visited[next] = 1;
+        stack[stackCount++] = next;
+    }
+    free(stack);
+    free(visited);
+}
+
+static void GenerateOpenField(PathGrid *grid, unsigned int *state)
+{
+    int wallCount = grid->width * grid->height / 400;
+    for (int i = 0; i < wallCount; i++)
+    {
+        int x = BenchmarkRandomValue(state, 0, grid->width - 1);
+        int y = BenchmarkRandomValue(state, 0, grid->height - 1);
+        grid->blockedCells[y * grid->width + x] = 1;
+    }
+}
+
+static void GenerateOutdoor(PathGrid *grid, unsigned int *state)
+{
+    int rockCount = grid->width * grid->height / 5000;
+    for (int i = 0; i < rockCount; i++)
+    {
+        int x = BenchmarkRandomValue(state, 0, grid->width - 1);
+        int y = BenchmarkRandomValue(state, 0, grid->height - 1);
+        int size = BenchmarkRandomValue(state, 0, 3);
+        for (int j = -size; j <= size; j++)
+        {
+            for (int k = -size; k <= size; k++)
+            {
+                if (PathGrid_contains(grid, x + k, y + j))
+                {
+                    grid->blockedCells[(y + j) * grid->width + x + k] = 1;
+                }
+            }
+        }
+    }
+}
+
+void GenerateBenchmarkMap(PathGrid *grid, BenchmarkMapType type, unsigned int seed)
+{
+    unsigned int state = seed != 0 ? seed : 1;
+    for (int i = 0; i < grid->width * grid->height; i++)
+    {
+        grid->blockedCells[i] = 0;
+    }
+    switch (type)
+    {
+        case BENCHMARK_MAP_RANDOM_BLOCKS:
+            GenerateRandomBlocks(grid, &state);
+            break;
+        case BENCHMARK_MAP_MAZE:
+            GenerateMaze(grid, &state);
+            break;
+        case BENCHMARK_MAP_OPEN:
+            GenerateOpenField(grid, &state);
+            break;
+        case BENCHMARK_MAP_OUTDOOR:
+            GenerateOutdoor(grid, &state);
+            break;
+        default:
+            break;
+    }
+}
+
+const char *BenchmarkMapTypeName(BenchmarkMapType type)
+{
+    switch (type)
+    {
+        case BENCHMARK_MAP_RANDOM_BLOCKS:
+            return "random";
+        case BENCHMARK_MAP_MAZE:
+            return "maze";
+        case BENCHMARK_MAP_OPEN:
+            return "open";
+        case BENCHMARK_MAP_OUTDOOR:
+            return "outdoor";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,41 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - benchmark maps
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef BENCHMARK_MAPS_H
+#define BENCHMARK_MAPS_H
+
+#include "pathfinding.h"
+
+typedef enum BenchmarkMapType
+{
+    // square blocks like AppState_randomizeBlocks, with the block count scaled to the map area
+    BENCHMARK_MAP_RANDOM_BLOCKS,
+    // a maze with corridors that are 3 cells wide, every free cell reaches every other one
+    BENCHMARK_MAP_MAZE,
+    // a few single wall cells on an otherwise empty map
+    BENCHMARK_MAP_OPEN,
+    // rocks of up to 7x7 cells far apart, most of the map is far from any wall
+    BENCHMARK_MAP_OUTDOOR,
+    BENCHMARK_MAP_TYPE_COUNT,
+} BenchmarkMapType;
+
+// xorshift generator so the maps are the same on every run and platform; the state must
+// not be 0. Returns a value from min to max, both included.
+int BenchmarkRandomValue(unsigned int *state, int min, int max);
+
+// fills the blocked cells of the grid, the same seed always generates the same map. The SDF
+// is not computed.
+void GenerateBenchmarkMap(PathGrid *grid, BenchmarkMapType type, unsigned int seed);
+
+const char *BenchmarkMapTypeName(BenchmarkMapType type);
+
+#endif
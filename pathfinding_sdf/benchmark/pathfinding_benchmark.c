@@ -0,0 +1,814 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - headless benchmark
+*
+*   Compares the binary heap open list of Agent_findPath against the linear scan queue
+*   that was used before and measures the SDF generation. Runs without a window, raylib
+*   is only used for its types.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "pathfinding.h"
+#include "sdf.h"
+#include "incremental_planner.h"
+#include "path_batch.h"
+#include "flow_field.h"
+#include "hierarchical_graph.h"
+#include "jump_point_search.h"
+#include "path_smoothing.h"
+#include "sdf_pyramid.h"
+#include "path_request.h"
+#include "clearance_labels.h"
+#include "benchmark_maps.h"
+
+#include <stdio.h> // Required for: printf
+#include <stdlib.h> // Required for: malloc, free
+#include <time.h> // Required for: timespec_get
+
+static double GetSeconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// random state of the queries, the maps have their own
+static unsigned int randomState = 1;
+
+static int RandomValue(int min, int max)
+{
+    return BenchmarkRandomValue(&randomState, min, max);
+}
+
+typedef struct LinearScanNode
+{
+    int x, y;
+    int score;
+} LinearScanNode;
+
+// the search as it was before the binary heap: the lowest score is found with a linear scan
+// and cells are queued again every time their score improves
+static void Agent_findPathLinearScan(Agent *agent, int enableJumping)
+{
+    const PathGrid *grid = agent->grid;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    const unsigned short *sdfCells = grid->sdfCells;
+    LinearScanNode *queue = (LinearScanNode *)RL_MALLOC(gridWidth * gridHeight * sizeof(LinearScanNode));
+    PathMap *map = &agent->map;
+    int unitSize = agent->unitSize;
+    int sdfFactor = agent->wallFactor;
+    int startX = agent->targetX;
+    int startY = agent->targetY;
+    PathMap_reset(map);
+
+    int queueLength = 1;
+    queue[0] = (LinearScanNode){ .x = startX, .y = startY, .score = 1 };
+    PathMap_set(map, startY * gridWidth + startX, PATH_NO_PARENT, 1);
+
+    int expandedCount = 0;
+    while (queueLength > 0)
+    {
+        int lowestScoreIndex = 0;
+        for (int i=1;i<queueLength;i++)
+        {
+            if (queue[i].score < queue[lowestScoreIndex].score)
+            {
+                lowestScoreIndex = i;
+            }
+        }
+        LinearScanNode node = queue[lowestScoreIndex];
+        for (int i=lowestScoreIndex+1;i<queueLength;i++)
+        {
+            queue[i-1] = queue[i];
+        }
+        queueLength--;
+        expandedCount++;
+
+        int cellSdf = sdfCells[node.y * gridWidth + node.x];
+        int maxDistance = cellSdf - unitSize;
+        if (maxDistance < 1)
+        {
+            maxDistance = 1;
+        }
+        int cellSdfValue = cellSdf < SDF_WALL_FACTOR_RANGE ? cellSdf : SDF_WALL_FACTOR_RANGE;
+
+        for (int i=0; i<neighborOffsetCount; i++)
+        {
+            int stepDistance = neighborOffsets[i].distance;
+            if (stepDistance > maxDistance || (!enableJumping && stepDistance > 1))
+            {
+                continue;
+            }
+
+            int x = node.x + neighborOffsets[i].x;
+            int y = node.y + neighborOffsets[i].y;
+            if (x < 0 || x >= gridWidth || y < 0 || y >= gridHeight)
+            {
+                continue;
+            }
+
+            int nextSdf = sdfCells[y * gridWidth + x];
+            if (nextSdf < unitSize)
+            {
+                continue;
+            }
+
+            int sdfValue = nextSdf < SDF_WALL_FACTOR_RANGE ? nextSdf : SDF_WALL_FACTOR_RANGE;
+            int integratedSdfValue = (sdfValue + cellSdfValue) * (stepDistance + 1) / 2;
+            int score = node.score + stepDistance + integratedSdfValue * sdfFactor / 6;
+            int previousScore = PathMap_score(map, y * gridWidth + x);
+            if (previousScore == 0 || score < previousScore)
+            {
+                PathMap_set(map, y * gridWidth + x, node.y * gridWidth + node.x, score);
+                queue[queueLength] = (LinearScanNode){ .x = x, .y = y, .score = score };
+                queueLength++;
+                if (queueLength >= gridWidth * gridHeight)
+                {
+                    queueLength = gridWidth * gridHeight - 1;
+                }
+            }
+        }
+    }
+
+    agent->expandedCount = expandedCount;
+    RL_FREE(queue);
+}
+
+typedef struct BenchmarkResult
+{
+    double seconds;
+    long long expandedCount;
+    long long startScoreSum;
+} BenchmarkResult;
+
+static BenchmarkResult RunQueries(Agent *agent, int queryCount, int enableJumping, int linearScan)
+{
+    BenchmarkResult result = { 0 };
+    randomState = 12345;
+    for (int i = 0; i < queryCount; i++)
+    {
+        agent->targetX = RandomValue(0, agent->grid->width - 1);
+        agent->targetY = RandomValue(0, agent->grid->height - 1);
+        double start = GetSeconds();
+        if (linearScan)
+        {
+            Agent_findPathLinearScan(agent, enableJumping);
+        }
+        else
+        {
+            Agent_findPath(agent, enableJumping);
+        }
+        result.seconds += GetSeconds() - start;
+        result.expandedCount += agent->expandedCount;
+        result.startScoreSum += PathMap_score(&agent->map, agent->startY * agent->grid->width + agent->startX);
+    }
+    return result;
+}
+
+static void PrintResult(const char *name, int queryCount, BenchmarkResult result)
+{
+    printf("  %-12s %8.3f ms/query %10lld nodes %12.0f nodes/sec\n", name,
+        result.seconds * 1000.0 / queryCount, result.expandedCount / queryCount,
+        result.expandedCount / result.seconds);
+}
+
+// hash over the paths of all agents, to check that the results don't depend on the thread count
+static unsigned int HashPaths(Agent *agents, int agentCount)
+{
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < agentCount; i++)
+    {
+        for (int j = 0; j < agents[i].pathCount; j++)
+        {
+            hash = (hash ^ (unsigned int)(agents[i].path[j].y * agents[i].grid->width + agents[i].path[j].x)) * 16777619u;
+        }
+        hash = (hash ^ (unsigned int)agents[i].pathCount) * 16777619u;
+    }
+    return hash;
+}
+
+// the agents are spread over two maps of different size, a batch can search any number of
+// grids at the same time
+static void RunBatchBenchmark(int width, int height, int agentCount)
+{
+    PathGrid *grids[2] = { PathGrid_create(width, height), PathGrid_create(width * 2, height / 2) };
+    for (int g = 0; g < 2; g++)
+    {
+        GenerateBenchmarkMap(grids[g], BENCHMARK_MAP_RANDOM_BLOCKS, 1234 + g);
+        ComputeSDF(grids[g], SDF_EUCLIDEAN);
+    }
+
+    Agent *agents = (Agent *)RL_MALLOC(agentCount * sizeof(Agent));
+    Agent **agentList = (Agent **)RL_MALLOC(agentCount * sizeof(Agent *));
+    randomState = 99;
+    for (int i = 0; i < agentCount; i++)
+    {
+        PathGrid *grid = grids[i % 2];
+        agents[i] = Agent_init(grid, RandomValue(0, grid->width - 1), RandomValue(0, grid->height - 1), RandomValue(1, 2),
+            RandomValue(0, grid->width - 1), RandomValue(0, grid->height - 1), RandomValue(0, 7), NULL, 0, WHITE);
+        agentList[i] = &agents[i];
+    }
+
+    printf("%dx%d and %dx%d, batch of %d agents\n", width, height, width * 2, height / 2, agentCount);
+    const int threadCounts[] = { 1, 2, 4, 8 };
+    double singleThreadSeconds = 0.0;
+    unsigned int firstHash = 0;
+    for (int t = 0; t < (int)(sizeof(threadCounts) / sizeof(threadCounts[0])); t++)
+    {
+        PathWorkerPool *pool = PathWorkerPool_create(threadCounts[t]);
+        double start = GetSeconds();
+        Agent_findPathBatch(pool, agentList, agentCount, 1);
+        double seconds = GetSeconds() - start;
+        PathWorkerPool_destroy(pool);
+
+        unsigned int hash = HashPaths(agents, agentCount);
+        if (t == 0)
+        {
+            singleThreadSeconds = seconds;
+            firstHash = hash;
+        }
+        printf("  %d threads %8.3f ms %8.1f agents/sec speedup %.2fx%s\n", threadCounts[t], seconds * 1000.0,
+            agentCount / seconds, singleThreadSeconds / seconds, hash == firstHash ? "" : " (paths differ!)");
+    }
+
+    for (int i = 0; i < agentCount; i++)
+    {
+        Agent_free(&agents[i]);
+    }
+    RL_FREE(agents);
+    RL_FREE(agentList);
+    PathGrid_destroy(grids[0]);
+    PathGrid_destroy(grids[1]);
+}
+
+// many units running to a few shared targets, searched one by one and with cached flow fields
+static void RunFlowFieldBenchmark(int width, int height, int agentCount, int targetCount)
+{
+    PathGrid *grid = PathGrid_create(width, height);
+    GenerateBenchmarkMap(grid, BENCHMARK_MAP_RANDOM_BLOCKS, 1234);
+    ComputeSDF(grid, SDF_EUCLIDEAN);
+
+    Agent *agents = (Agent *)RL_MALLOC(agentCount * sizeof(Agent));
+    randomState = 55;
+    for (int i = 0; i < agentCount; i++)
+    {
+        int target = i % targetCount;
+        agents[i] = Agent_init(grid, RandomValue(0, width - 1), RandomValue(0, height - 1), 1 + target % 2,
+            width * (target + 1) / (targetCount + 1), height / 2, 2, NULL, 0, WHITE);
+    }
+
+    printf("%dx%d, %d agents with %d targets\n", width, height, agentCount, targetCount);
+    double start = GetSeconds();
+    for (int i = 0; i < agentCount; i++)
+    {
+        Agent_findPath(&agents[i], 1);
+    }
+    double searchSeconds = GetSeconds() - start;
+    unsigned int searchHash = HashPaths(agents, agentCount);
+
+    FlowFieldCache cache = FlowFieldCache_init(grid, targetCount);
+    start = GetSeconds();
+    for (int i = 0; i < agentCount; i++)
+    {
+        Agent_followFlowField(&agents[i], FlowFieldCache_getForAgent(&cache, &agents[i], 1));
+    }
+    double flowFieldSeconds = GetSeconds() - start;
+    unsigned int flowFieldHash = HashPaths(agents, agentCount);
+
+    printf("  per agent   %8.3f ms\n", searchSeconds * 1000.0);
+    printf("  flow fields %8.3f ms, %d searches, speedup %.1fx%s\n", flowFieldSeconds * 1000.0, cache.missCount,
+        searchSeconds / flowFieldSeconds, searchHash == flowFieldHash ? "" : " (paths differ!)");
+
+    FlowFieldCache_free(&cache);
+    for (int i = 0; i < agentCount; i++)
+    {
+        Agent_free(&agents[i]);
+    }
+    RL_FREE(agents);
+    PathGrid_destroy(grid);
+}
+
+// queries on a large map through the hierarchical graph; the flat search is only compared
+// on maps where it still runs in reasonable time
+static void RunHierarchicalBenchmark(int width, int height, int clusterSize, int queryCount, int compareFlat)
+{
+    PathGrid *grid = PathGrid_create(width, height);
+    GenerateBenchmarkMap(grid, BENCHMARK_MAP_RANDOM_BLOCKS, 1234);
+    ComputeSDF(grid, SDF_EUCLIDEAN);
+
+    // without a wall factor the distance estimate of the abstract search is close to the
+    // real costs, with a high wall factor it visits more nodes
+    const int unitSize = 1;
+    const int wallFactor = 0;
+    double start = GetSeconds();
+    HierarchicalGraph graph = HierarchicalGraph_build(grid, clusterSize, unitSize, wallFactor, 0);
+    double buildSeconds = GetSeconds() - start;
+    printf("%dx%d, hierarchical graph with %dx%d clusters: %d nodes, %d edges, built in %.1f ms\n", width, height,
+        clusterSize, clusterSize, graph.nodeCount, graph.edgeCount, buildSeconds * 1000.0);
+
+    int maxPathCount = width * height;
+    PathPoint *path = (PathPoint *)RL_MALLOC(maxPathCount * sizeof(PathPoint));
+    Agent agent = { 0 };
+    if (compareFlat)
+    {
+        agent = Agent_init(grid, 0, 0, unitSize, 0, 0, wallFactor, NULL, 0, WHITE);
+    }
+
+    // a unit only needs the start of a long path to walk on, the rest is refined later
+    const int partialPathCount = 64;
+    double abstractSeconds = 0.0;
+    double refineSeconds = 0.0;
+    double partialRefineSeconds = 0.0;
+    double flatSeconds = 0.0;
+    long long expandedCount = 0;
+    long long pathCellCount = 0;
+    double scoreRatio = 0.0;
+    int foundCount = 0;
+    randomState = 31;
+    for (int i = 0; i < queryCount; i++)
+    {
+        // start and target on opposite sides of the map
+        int startX = RandomValue(0, width / 8);
+        int startY = RandomValue(0, height - 1);
+        int targetX = RandomValue(width - width / 8, width - 1);
+        int targetY = RandomValue(0, height - 1);
+
+        start = GetSeconds();
+        int abstractCount = HierarchicalGraph_findAbstractPath(&graph, startX, startY, targetX, targetY);
+        abstractSeconds += GetSeconds() - start;
+        expandedCount += graph.expandedCount;
+        if (abstractCount == 0)
+        {
+            continue;
+        }
+        start = GetSeconds();
+        HierarchicalGraph_refinePath(&graph, path, partialPathCount);
+        partialRefineSeconds += GetSeconds() - start;
+        start = GetSeconds();
+        int pathCount = HierarchicalGraph_refinePath(&graph, path, maxPathCount);
+        refineSeconds += GetSeconds() - start;
+        pathCellCount += pathCount;
+        foundCount++;
+
+        if (compareFlat)
+        {
+            agent.startX = startX;
+            agent.startY = startY;
+            agent.targetX = targetX;
+            agent.targetY = targetY;
+            start = GetSeconds();
+            Agent_findPath(&agent, 0);
+            flatSeconds += GetSeconds() - start;
+            scoreRatio += (double)graph.pathScore / agent.pathScore;
+        }
+    }
+
+    printf("  abstract     %8.3f ms/query %10lld nodes\n", abstractSeconds * 1000.0 / queryCount, expandedCount / queryCount);
+    printf("  refined      %8.3f ms/query %10lld path cells\n", refineSeconds * 1000.0 / foundCount, pathCellCount / foundCount);
+    printf("  full query   %8.3f ms/query, abstract and refined path\n", (abstractSeconds / queryCount + refineSeconds / foundCount) * 1000.0);
+    printf("  first cells  %8.3f ms/query, abstract and first %d path cells\n",
+        (abstractSeconds / queryCount + partialRefineSeconds / foundCount) * 1000.0, partialPathCount);
+    if (compareFlat)
+    {
+        printf("  flat         %8.3f ms/query, hierarchical path scores %.1f%% higher\n", flatSeconds * 1000.0 / foundCount,
+            (scoreRatio / foundCount - 1.0) * 100.0);
+        Agent_free(&agent);
+    }
+
+    RL_FREE(path);
+    HierarchicalGraph_free(&graph);
+    PathGrid_destroy(grid);
+}
+
+// jump point search against the flat search with and without jumping, for a unit without
+// wall factor, where jump point search finds the same path cost as the search without jumping
+static void RunJumpPointBenchmark(int width, int height, int queryCount)
+{
+    PathGrid *grid = PathGrid_create(width, height);
+    GenerateBenchmarkMap(grid, BENCHMARK_MAP_RANDOM_BLOCKS, 1234);
+    ComputeSDF(grid, SDF_EUCLIDEAN);
+
+    Agent agent = Agent_init(grid, 0, 0, 1, 0, 0, 0, NULL, 0, WHITE);
+    BenchmarkResult jumping = { 0 };
+    BenchmarkResult walking = { 0 };
+    BenchmarkResult jumpPoints = { 0 };
+    int differentCount = 0;
+    randomState = 8;
+    for (int i = 0; i < queryCount; i++)
+    {
+        agent.startX = RandomValue(0, width - 1);
+        agent.startY = RandomValue(0, height - 1);
+        agent.targetX = RandomValue(0, width - 1);
+        agent.targetY = RandomValue(0, height - 1);
+
+        double start = GetSeconds();
+        Agent_findPath(&agent, 1);
+        jumping.seconds += GetSeconds() - start;
+        jumping.expandedCount += agent.expandedCount;
+
+        start = GetSeconds();
+        Agent_findPath(&agent, 0);
+        walking.seconds += GetSeconds() - start;
+        walking.expandedCount += agent.expandedCount;
+        int walkingScore = agent.pathScore;
+
+        start = GetSeconds();
+        Agent_findPathJumpPoints(&agent);
+        jumpPoints.seconds += GetSeconds() - start;
+        jumpPoints.expandedCount += agent.expandedCount;
+        differentCount += walkingScore != agent.pathScore;
+    }
+
+    printf("%dx%d, jump point search, %d queries\n", width, height, queryCount);
+    PrintResult("jumping", queryCount, jumping);
+    PrintResult("no jumping", queryCount, walking);
+    PrintResult("jump points", queryCount, jumpPoints);
+    printf("  path scores %s\n", differentCount == 0 ? "same as without jumping" : "differ from the search without jumping!");
+
+    // short queries are where the setup of a search shows, the searches reuse the
+    // thread's arena and the generation stamps of the map instead of clearing it
+    const int shortQueryCount = 1000;
+    BenchmarkResult shortQueries = { 0 };
+    for (int i = 0; i < shortQueryCount; i++)
+    {
+        agent.startX = RandomValue(10, width - 11);
+        agent.startY = RandomValue(10, height - 11);
+        agent.targetX = agent.startX + RandomValue(-8, 8);
+        agent.targetY = agent.startY + RandomValue(-8, 8);
+        if (grid->blockedCells[agent.startY * width + agent.startX] || grid->blockedCells[agent.targetY * width + agent.targetX])
+        {
+            // a blocked start can't be reached and the search would visit the whole map
+            i--;
+            continue;
+        }
+        double start = GetSeconds();
+        Agent_findPathJumpPoints(&agent);
+        shortQueries.seconds += GetSeconds() - start;
+        shortQueries.expandedCount += agent.expandedCount;
+    }
+    PrintResult("short", shortQueryCount, shortQueries);
+
+    Agent_free(&agent);
+    PathGrid_destroy(grid);
+}
+
+// node count of the paths before and after removing the nodes that can be skipped in a
+// straight line, on several random maps and with jumping on and off
+static void RunSmoothingBenchmark(int width, int height, int mapCount, int queryCount)
+{
+    PathGrid *grid = PathGrid_create(width, height);
+    Agent agent = Agent_init(grid, 0, 0, 1, 0, 0, 2, NULL, 0, WHITE);
+    printf("%dx%d, path smoothing, %d maps with %d queries\n", width, height, mapCount, queryCount);
+    for (int enableJumping = 0; enableJumping <= 1; enableJumping++)
+    {
+        long long nodeCount = 0;
+        long long smoothedNodeCount = 0;
+        double length = 0.0;
+        double smoothedLength = 0.0;
+        double seconds = 0.0;
+        int pathCount = 0;
+        for (int m = 0; m < mapCount; m++)
+        {
+            GenerateBenchmarkMap(grid, BENCHMARK_MAP_RANDOM_BLOCKS, 1000 + m);
+            ComputeSDF(grid, SDF_EUCLIDEAN);
+            randomState = 99 + m;
+            for (int i = 0; i < queryCount; i++)
+            {
+                agent.unitSize = RandomValue(1, 2);
+                agent.startX = RandomValue(0, width - 1);
+                agent.startY = RandomValue(0, height - 1);
+                agent.targetX = RandomValue(0, width - 1);
+                agent.targetY = RandomValue(0, height - 1);
+                Agent_findPath(&agent, enableJumping);
+                if (agent.pathCount == 0)
+                {
+                    continue;
+                }
+                nodeCount += agent.pathCount;
+                length += CalcPathLength(agent.path, agent.pathCount);
+
+                double start = GetSeconds();
+                Agent_smoothPath(&agent);
+                seconds += GetSeconds() - start;
+                smoothedNodeCount += agent.pathCount;
+                smoothedLength += CalcPathLength(agent.path, agent.pathCount);
+                pathCount++;
+            }
+        }
+        printf("  jumping %-3s %6lld -> %5lld nodes/path (%.1f%% removed), length %.1f -> %.1f, %.4f ms/path\n",
+            enableJumping ? "on" : "off", nodeCount / pathCount, smoothedNodeCount / pathCount,
+            100.0 - 100.0 * smoothedNodeCount / nodeCount, length / pathCount, smoothedLength / pathCount,
+            seconds * 1000.0 / pathCount);
+    }
+    Agent_free(&agent);
+    PathGrid_destroy(grid);
+}
+
+// nodes the search on the SDF mip chain expands compared to the search with jumping, which
+// doesn't stop at the start: its count is the number of cells it reached with a lower
+// score than the start, the ones it expanded before the start
+static void RunMultiResolutionBenchmark(int width, int height, int queryCount)
+{
+    printf("%dx%d, multi-resolution search, %d queries\n", width, height, queryCount);
+    PathGrid *grid = PathGrid_create(width, height);
+    const BenchmarkMapType types[] = { BENCHMARK_MAP_RANDOM_BLOCKS, BENCHMARK_MAP_OPEN, BENCHMARK_MAP_OUTDOOR };
+    for (int t = 0; t < (int)(sizeof(types) / sizeof(types[0])); t++)
+    {
+        GenerateBenchmarkMap(grid, types[t], 1234);
+        ComputeSDF(grid, SDF_EUCLIDEAN);
+        SDFPyramid pyramid = SDFPyramid_init(grid, SDF_PYRAMID_MAX_LEVELS);
+        SDFPyramid_update(&pyramid);
+        Agent agent = Agent_init(grid, 0, 0, 1, 0, 0, 2, NULL, 0, WHITE);
+
+        long long expandedCount = 0;
+        long long pyramidExpandedCount = 0;
+        long long scoreSum = 0;
+        long long pyramidScoreSum = 0;
+        double seconds = 0.0;
+        double pyramidSeconds = 0.0;
+        int pathCount = 0;
+        randomState = 64;
+        for (int i = 0; i < queryCount; i++)
+        {
+            agent.startX = RandomValue(0, width - 1);
+            agent.startY = RandomValue(0, height - 1);
+            agent.targetX = RandomValue(0, width - 1);
+            agent.targetY = RandomValue(0, height - 1);
+            double start = GetSeconds();
+            Agent_findPath(&agent, 1);
+            seconds += GetSeconds() - start;
+            if (agent.pathCount == 0)
+            {
+                continue;
+            }
+            int pathScore = agent.pathScore;
+            for (int cell = 0; cell < width * height; cell++)
+            {
+                int score = PathMap_score(&agent.map, cell);
+                expandedCount += score > 0 && score <= pathScore;
+            }
+            scoreSum += pathScore;
+
+            start = GetSeconds();
+            Agent_findPathMultiResolution(&agent, &pyramid);
+            pyramidSeconds += GetSeconds() - start;
+            pyramidExpandedCount += agent.expandedCount;
+            pyramidScoreSum += agent.pathScore;
+            pathCount++;
+        }
+        printf("  %-8s %8lld -> %7lld nodes/query (%.1fx fewer), path scores %+.1f%%, %.3f -> %.3f ms/query\n",
+            BenchmarkMapTypeName(types[t]), expandedCount / pathCount, pyramidExpandedCount / pathCount,
+            (double)expandedCount / pyramidExpandedCount, 100.0 * (pyramidScoreSum - scoreSum) / scoreSum,
+            seconds * 1000.0 / queryCount, pyramidSeconds * 1000.0 / pathCount);
+        Agent_free(&agent);
+        SDFPyramid_free(&pyramid);
+    }
+    PathGrid_destroy(grid);
+}
+
+// agents searching on a large maze after the map changed: all at once like the app did,
+// which stalls one frame for the sum of the searches, and time sliced with a frame budget
+static void RunTimeSlicedBenchmark(int width, int height, int agentCount, int budgetMicroseconds)
+{
+    PathGrid *grid = PathGrid_create(width, height);
+    GenerateBenchmarkMap(grid, BENCHMARK_MAP_MAZE, 1234);
+    ComputeSDF(grid, SDF_EUCLIDEAN);
+
+    Agent *agents = (Agent *)RL_MALLOC(agentCount * sizeof(Agent));
+    randomState = 31;
+    for (int i = 0; i < agentCount; i++)
+    {
+        agents[i] = Agent_init(grid, 0, 0, 1, 0, 0, 2, NULL, 0, WHITE);
+        agents[i].startX = RandomValue(0, width - 1);
+        agents[i].startY = RandomValue(0, height - 1);
+        agents[i].targetX = RandomValue(0, width - 1);
+        agents[i].targetY = RandomValue(0, height - 1);
+    }
+
+    printf("%dx%d maze, %d agents, frame budget %d us\n", width, height, agentCount, budgetMicroseconds);
+    double start = GetSeconds();
+    for (int i = 0; i < agentCount; i++)
+    {
+        Agent_findPath(&agents[i], 1);
+    }
+    double syncSeconds = GetSeconds() - start;
+    unsigned int syncHash = HashPaths(agents, agentCount);
+    printf("  synchronous  1 frame  %8.3f ms\n", syncSeconds * 1000.0);
+
+    PathRequestQueue *queue = PathRequestQueue_create();
+    for (int i = 0; i < agentCount; i++)
+    {
+        PathRequestQueue_request(queue, &agents[i], 1);
+    }
+    int frameCount = 0;
+    double slicedSeconds = 0.0;
+    double maxFrameSeconds = 0.0;
+    while (PathRequestQueue_pendingCount(queue) > 0)
+    {
+        start = GetSeconds();
+        PathRequestQueue_update(queue, budgetMicroseconds);
+        double frameSeconds = GetSeconds() - start;
+        slicedSeconds += frameSeconds;
+        maxFrameSeconds = frameSeconds > maxFrameSeconds ? frameSeconds : maxFrameSeconds;
+        frameCount++;
+    }
+    printf("  time sliced %2d frames %8.3f ms, longest frame %.3f ms%s\n", frameCount, slicedSeconds * 1000.0,
+        maxFrameSeconds * 1000.0, HashPaths(agents, agentCount) == syncHash ? "" : " (paths differ!)");
+    PathRequestQueue_destroy(queue);
+
+    for (int i = 0; i < agentCount; i++)
+    {
+        Agent_free(&agents[i]);
+    }
+    RL_FREE(agents);
+    PathGrid_destroy(grid);
+}
+
+// units in a walled off room ordered out of it: without labels each search floods everything
+// that can be reached from the target before it gives up, with labels it is rejected before
+// it starts
+static void RunUnreachableBenchmark(int width, int height, int queryCount)
+{
+    PathGrid *grid = PathGrid_create(width, height);
+    GenerateBenchmarkMap(grid, BENCHMARK_MAP_RANDOM_BLOCKS, 1234);
+    int roomSize = width / 8;
+    int roomX = width / 2 - roomSize / 2;
+    int roomY = height / 2 - roomSize / 2;
+    for (int i = 0; i <= roomSize; i++)
+    {
+        grid->blockedCells[roomY * width + roomX + i] = 1;
+        grid->blockedCells[(roomY + roomSize) * width + roomX + i] = 1;
+        grid->blockedCells[(roomY + i) * width + roomX] = 1;
+        grid->blockedCells[(roomY + i) * width + roomX + roomSize] = 1;
+    }
+    ComputeSDF(grid, SDF_EUCLIDEAN);
+
+    printf("%dx%d, units in a walled off room, %d queries\n", width, height, queryCount);
+    Agent agent = Agent_init(grid, 0, 0, 1, 0, 0, 2, NULL, 0, WHITE);
+    for (int labeled = 0; labeled <= 1; labeled++)
+    {
+        if (labeled)
+        {
+            double start = GetSeconds();
+            PathGrid_enableClearanceLabels(grid, 2);
+            printf("  labeling 2 classes %.3f ms\n", (GetSeconds() - start) * 1000.0);
+        }
+        randomState = 17;
+        double seconds = 0.0;
+        long long expandedCount = 0;
+        for (int i = 0; i < queryCount; i++)
+        {
+            // the units are in the room, the targets outside of it and not next to a wall
+            agent.startX = RandomValue(roomX + 1, roomX + roomSize - 1);
+            agent.startY = RandomValue(roomY + 1, roomY + roomSize - 1);
+            do
+            {
+                agent.targetX = RandomValue(0, width - 1);
+                agent.targetY = RandomValue(0, height - 1);
+            } while (grid->sdfCells[agent.targetY * width + agent.targetX] < 3 ||
+                (agent.targetX >= roomX && agent.targetX <= roomX + roomSize && agent.targetY >= roomY && agent.targetY <= roomY + roomSize));
+            double start = GetSeconds();
+            Agent_findPath(&agent, 1);
+            seconds += GetSeconds() - start;
+            expandedCount += agent.expandedCount;
+        }
+        printf("  %-15s %10.4f ms/query %9lld nodes/query\n", labeled ? "with labels" : "without labels",
+            seconds * 1000.0 / queryCount, expandedCount / queryCount);
+    }
+
+    // painting single cells and erasing them again, the labels are updated with the SDF
+    const int paintCount = 200;
+    double seconds[2] = { 0.0, 0.0 };
+    for (int labeled = 1; labeled >= 0; labeled--)
+    {
+        for (int i = 0; i < paintCount * 2; i++)
+        {
+            if (i % paintCount == 0)
+            {
+                randomState = 777;
+            }
+            int x = RandomValue(0, width - 1);
+            int y = RandomValue(0, height - 1);
+            double start = GetSeconds();
+            SetCellBlocked(grid, x, y, !grid->blockedCells[y * width + x]);
+            UpdateSDFCells(grid);
+            seconds[labeled] += GetSeconds() - start;
+        }
+        PathGrid_disableClearanceLabels(grid);
+    }
+    printf("  patching a painted cell %.4f ms, %.4f ms with labels\n", seconds[0] * 1000.0 / (paintCount * 2),
+        seconds[1] * 1000.0 / (paintCount * 2));
+    Agent_free(&agent);
+    PathGrid_destroy(grid);
+}
+
+int main(void)
+{
+    const int sizes[][3] = {
+        // width, height, query count
+        { 80, 45, 50 },
+        { 256, 256, 5 },
+        { 512, 512, 2 },
+    };
+
+    for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+    {
+        int width = sizes[s][0];
+        int height = sizes[s][1];
+        int queryCount = sizes[s][2];
+        PathGrid *grid = PathGrid_create(width, height);
+        GenerateBenchmarkMap(grid, BENCHMARK_MAP_RANDOM_BLOCKS, 1234);
+
+        double sdfStart = GetSeconds();
+        ComputeSDF(grid, SDF_EUCLIDEAN);
+        double sdfSeconds = GetSeconds() - sdfStart;
+
+        // painting single cells, each one patched into the SDF on its own
+        const int paintCount = 200;
+        randomState = 777;
+        double patchStart = GetSeconds();
+        for (int i = 0; i < paintCount; i++)
+        {
+            int x = RandomValue(0, width - 1);
+            int y = RandomValue(0, height - 1);
+            SetCellBlocked(grid, x, y, !grid->blockedCells[y * width + x]);
+            UpdateSDFCells(grid);
+        }
+        double patchSeconds = (GetSeconds() - patchStart) / paintCount;
+        printf("%dx%d, SDF %.3f ms, patching a painted cell %.4f ms\n", width, height, sdfSeconds * 1000.0, patchSeconds * 1000.0);
+        GenerateBenchmarkMap(grid, BENCHMARK_MAP_RANDOM_BLOCKS, 1234);
+        ComputeSDF(grid, SDF_EUCLIDEAN);
+
+        for (int enableJumping = 0; enableJumping <= 1; enableJumping++)
+        {
+            Agent agent = Agent_init(grid, 5, height / 2, 1, width - 5, height / 2, 2, NULL, 0, WHITE);
+            printf("%dx%d, jumping %s, %d queries\n", width, height, enableJumping ? "on" : "off", queryCount);
+            BenchmarkResult linear = RunQueries(&agent, queryCount, enableJumping, 1);
+            BenchmarkResult heap = RunQueries(&agent, queryCount, enableJumping, 0);
+            PrintResult("linear scan", queryCount, linear);
+            PrintResult("binary heap", queryCount, heap);
+            printf("  speedup %.1fx%s\n", linear.seconds / heap.seconds,
+                linear.startScoreSum == heap.startScoreSum ? "" : " (path scores differ!)");
+
+            // painting single cells and repairing the search instead of searching again
+            Agent_enableIncrementalPlanner(&agent);
+            Agent_findPath(&agent, enableJumping);
+            randomState = 4242;
+            double replanSeconds = 0.0;
+            long long replanExpandedCount = 0;
+            for (int i = 0; i < queryCount; i++)
+            {
+                SetCellBlocked(grid, RandomValue(0, width - 1), RandomValue(0, height - 1), 1);
+                UpdateSDFCells(grid);
+                double start = GetSeconds();
+                Agent_replan(&agent, enableJumping, grid->sdfChangedCells, grid->sdfChangedCount);
+                replanSeconds += GetSeconds() - start;
+                replanExpandedCount += agent.expandedCount;
+            }
+            PrintResult("replan", queryCount, (BenchmarkResult){ replanSeconds, replanExpandedCount, 0 });
+            GenerateBenchmarkMap(grid, BENCHMARK_MAP_RANDOM_BLOCKS, 1234);
+            ComputeSDF(grid, SDF_EUCLIDEAN);
+            Agent_free(&agent);
+        }
+
+        PathGrid_destroy(grid);
+    }
+
+    RunBatchBenchmark(256, 256, 32);
+    RunFlowFieldBenchmark(256, 256, 64, 4);
+    RunJumpPointBenchmark(256, 256, 20);
+    RunHierarchicalBenchmark(512, 512, 32, 10, 1);
+    RunHierarchicalBenchmark(4096, 4096, 32, 100, 0);
+    RunSmoothingBenchmark(256, 256, 5, 20);
+    RunMultiResolutionBenchmark(1024, 1024, 10);
+    RunTimeSlicedBenchmark(1024, 1024, 8, 2000);
+    RunUnreachableBenchmark(1024, 1024, 5);
+    PathSearchArena_releaseThread();
+
+    return 0;
+}
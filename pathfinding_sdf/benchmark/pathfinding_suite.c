@@ -0,0 +1,318 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - benchmark suite
+*
+*   Runs the SDF build, the SDF patching, the searches and the path extraction on a corpus
+*   of seeded maps and prints percentiles of the timings as CSV, one line per map type,
+*   size and stage. Needs no window or GPU, so it can run on CI machines to catch
+*   regressions. The checksum column only depends on the results, not on the timings: if
+*   it changes between two builds, the results of that stage changed.
+*
+*   Usage: pathfinding_sdf_suite [--quick] [--size N] [--seeds N]
+*     --quick    only the smallest size and one seed
+*     --size N   runs N x N maps instead of the default sizes
+*     --seeds N  number of maps per type and size
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "pathfinding.h"
+#include "sdf.h"
+#include "sdf_pyramid.h"
+#include "benchmark_maps.h"
+
+#include <stdio.h> // Required for: printf, fprintf
+#include <stdlib.h> // Required for: malloc, realloc, free, qsort, atoi
+#include <string.h> // Required for: strcmp
+#include <time.h> // Required for: timespec_get
+
+static double GetSeconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//------------------------------------------------------------------------------------
+// samples
+//------------------------------------------------------------------------------------
+// timings of one stage over all seeds of a map type and size
+typedef struct SampleSet
+{
+    double *values;
+    int count;
+    int capacity;
+    unsigned int checksum;
+} SampleSet;
+
+static SampleSet SampleSet_init(void)
+{
+    return (SampleSet){ NULL, 0, 0, 2166136261u };
+}
+
+static void SampleSet_add(SampleSet *set, double seconds, unsigned int result)
+{
+    if (set->count == set->capacity)
+    {
+        set->capacity = set->capacity == 0 ? 64 : set->capacity * 2;
+        set->values = (double*)realloc(set->values, sizeof(double) * set->capacity);
+    }
+    set->values[set->count++] = seconds;
+    set->checksum = (set->checksum ^ result) * 16777619u;
+}
+
+static int CompareDoubles(const void *a, const void *b)
+{
+    double valueA = *(const double*)a;
+    double valueB = *(const double*)b;
+    return (valueA > valueB) - (valueA < valueB);
+}
+
+// nearest rank percentile, the values have to be sorted
+static double SampleSet_percentile(const SampleSet *set, double percentile)
+{
+    int rank = (int)(percentile / 100.0 * set->count + 0.999999);
+    rank = rank < 1 ? 1 : (rank > set->count ? set->count : rank);
+    return set->values[rank - 1];
+}
+
+static void SampleSet_print(SampleSet *set, BenchmarkMapType type, int width, int height, const char *stage)
+{
+    if (set->count == 0)
+    {
+        return;
+    }
+    qsort(set->values, set->count, sizeof(double), CompareDoubles);
+    printf("%s,%d,%d,%s,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%08x\n", BenchmarkMapTypeName(type), width, height, stage, set->count,
+        set->values[0] * 1000.0, SampleSet_percentile(set, 50.0) * 1000.0, SampleSet_percentile(set, 90.0) * 1000.0,
+        SampleSet_percentile(set, 99.0) * 1000.0, set->values[set->count - 1] * 1000.0, set->checksum);
+    fflush(stdout);
+}
+
+static void SampleSet_free(SampleSet *set)
+{
+    free(set->values);
+    *set = SampleSet_init();
+}
+
+//------------------------------------------------------------------------------------
+// stages
+//------------------------------------------------------------------------------------
+static unsigned int HashSDF(const PathGrid *grid)
+{
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < grid->width * grid->height; i++)
+    {
+        hash = (hash ^ grid->sdfCells[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// a random cell where the unit fits, the SDF has to be computed
+static PathPoint RandomFreeCell(const PathGrid *grid, unsigned int *state, int unitSize)
+{
+    PathPoint cell = { 0, 0 };
+    for (int i = 0; i < 1000; i++)
+    {
+        cell.x = BenchmarkRandomValue(state, 0, grid->width - 1);
+        cell.y = BenchmarkRandomValue(state, 0, grid->height - 1);
+        if (grid->sdfCells[cell.y * grid->width + cell.x] >= unitSize)
+        {
+            break;
+        }
+    }
+    return cell;
+}
+
+enum
+{
+    STAGE_SDF_EUCLIDEAN,
+    STAGE_SDF_CHEBYSHEV,
+    STAGE_SDF_MANHATTAN,
+    STAGE_SDF_PATCH,
+    STAGE_SEARCH,
+    STAGE_SEARCH_JUMPING,
+    STAGE_SEARCH_MULTI_RESOLUTION,
+    STAGE_EXTRACT,
+    STAGE_COUNT,
+};
+
+static const char *stageNames[STAGE_COUNT] = {
+    "sdf_euclidean",
+    "sdf_chebyshev",
+    "sdf_manhattan",
+    "sdf_patch",
+    "search",
+    "search_jumping",
+    "search_multires",
+    "extract",
+};
+
+static void RunMap(PathGrid *grid, BenchmarkMapType type, unsigned int seed, int queryCount, SampleSet *stages)
+{
+    GenerateBenchmarkMap(grid, type, seed);
+    const int sdfRepeatCount = 3;
+    for (int sdfFunction = SDF_EUCLIDEAN; sdfFunction <= SDF_MANHATTAN; sdfFunction++)
+    {
+        for (int i = 0; i < sdfRepeatCount; i++)
+        {
+            double start = GetSeconds();
+            ComputeSDF(grid, sdfFunction);
+            double seconds = GetSeconds() - start;
+            SampleSet_add(&stages[STAGE_SDF_EUCLIDEAN + sdfFunction], seconds, HashSDF(grid));
+        }
+    }
+
+    // painting single cells like in the example, each one patched into the SDF on its own
+    ComputeSDF(grid, SDF_EUCLIDEAN);
+    unsigned int state = seed * 31 + 7;
+    for (int i = 0; i < 100; i++)
+    {
+        int x = BenchmarkRandomValue(&state, 0, grid->width - 1);
+        int y = BenchmarkRandomValue(&state, 0, grid->height - 1);
+        SetCellBlocked(grid, x, y, !grid->blockedCells[y * grid->width + x]);
+        double start = GetSeconds();
+        int changedCount = UpdateSDFCells(grid);
+        SampleSet_add(&stages[STAGE_SDF_PATCH], GetSeconds() - start, (unsigned int)changedCount);
+    }
+    GenerateBenchmarkMap(grid, type, seed);
+    ComputeSDF(grid, SDF_EUCLIDEAN);
+
+    Agent agent = Agent_init(grid, 0, 0, 1, 0, 0, 2, NULL, 0, WHITE);
+    for (int enableJumping = 0; enableJumping <= 1; enableJumping++)
+    {
+        state = seed * 17 + 3;
+        for (int i = 0; i < queryCount; i++)
+        {
+            PathPoint start = RandomFreeCell(grid, &state, agent.unitSize);
+            PathPoint target = RandomFreeCell(grid, &state, agent.unitSize);
+            agent.startX = start.x;
+            agent.startY = start.y;
+            agent.targetX = target.x;
+            agent.targetY = target.y;
+
+            double searchStart = GetSeconds();
+            Agent_findPath(&agent, enableJumping);
+            double searchSeconds = GetSeconds() - searchStart;
+            unsigned int result = (unsigned int)agent.pathScore * 31u + (unsigned int)agent.expandedCount;
+            SampleSet_add(&stages[enableJumping ? STAGE_SEARCH_JUMPING : STAGE_SEARCH], searchSeconds, result);
+
+            // the search extracts the path as well, this measures that part on its own
+            double extractStart = GetSeconds();
+            Agent_extractPath(&agent);
+            double extractSeconds = GetSeconds() - extractStart;
+            SampleSet_add(&stages[STAGE_EXTRACT], extractSeconds, (unsigned int)agent.pathCount);
+        }
+    }
+
+    // same queries on the SDF mip chain
+    SDFPyramid pyramid = SDFPyramid_init(grid, SDF_PYRAMID_MAX_LEVELS);
+    SDFPyramid_update(&pyramid);
+    state = seed * 17 + 3;
+    for (int i = 0; i < queryCount; i++)
+    {
+        PathPoint start = RandomFreeCell(grid, &state, agent.unitSize);
+        PathPoint target = RandomFreeCell(grid, &state, agent.unitSize);
+        agent.startX = start.x;
+        agent.startY = start.y;
+        agent.targetX = target.x;
+        agent.targetY = target.y;
+
+        double searchStart = GetSeconds();
+        Agent_findPathMultiResolution(&agent, &pyramid);
+        double searchSeconds = GetSeconds() - searchStart;
+        unsigned int result = (unsigned int)agent.pathScore * 31u + (unsigned int)agent.expandedCount;
+        SampleSet_add(&stages[STAGE_SEARCH_MULTI_RESOLUTION], searchSeconds, result);
+    }
+    SDFPyramid_free(&pyramid);
+    Agent_free(&agent);
+}
+
+int main(int argc, char **argv)
+{
+    int sizes[] = { 128, 512 };
+    int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+    int seedCount = 3;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            sizeCount = 1;
+            seedCount = 1;
+        }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            sizes[0] = atoi(argv[++i]);
+            sizeCount = 1;
+        }
+        else if (strcmp(argv[i], "--seeds") == 0 && i + 1 < argc)
+        {
+            seedCount = atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--quick] [--size N] [--seeds N]\n", argv[0]);
+            return 1;
+        }
+    }
+    // the random blocks keep a margin of 15 cells to the map border
+    if (sizes[0] < 64 || seedCount < 1)
+    {
+        fprintf(stderr, "the size has to be at least 64 and the seed count at least 1\n");
+        return 1;
+    }
+
+    printf("map,width,height,stage,samples,min_ms,p50_ms,p90_ms,p99_ms,max_ms,checksum\n");
+    for (int s = 0; s < sizeCount; s++)
+    {
+        int size = sizes[s];
+        // the searches don't stop at the target, the query count keeps the time per size similar
+        int queryCount = 1024 * 1024 / (size * size);
+        queryCount = queryCount < 3 ? 3 : (queryCount > 64 ? 64 : queryCount);
+        PathGrid *grid = PathGrid_create(size, size);
+        for (int type = 0; type < BENCHMARK_MAP_TYPE_COUNT; type++)
+        {
+            SampleSet stages[STAGE_COUNT];
+            for (int i = 0; i < STAGE_COUNT; i++)
+            {
+                stages[i] = SampleSet_init();
+            }
+            for (int seed = 1; seed <= seedCount; seed++)
+            {
+                RunMap(grid, (BenchmarkMapType)type, (unsigned int)seed, queryCount, stages);
+            }
+            for (int i = 0; i < STAGE_COUNT; i++)
+            {
+                SampleSet_print(&stages[i], (BenchmarkMapType)type, size, size, stageNames[i]);
+                SampleSet_free(&stages[i]);
+            }
+        }
+        PathGrid_destroy(grid);
+    }
+    PathSearchArena_releaseThread();
+
+    return 0;
+}
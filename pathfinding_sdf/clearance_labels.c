@@ -0,0 +1,481 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - clearance connectivity labels
+*
+*   A search that can't reach its goal only stops when it has expanded every cell the unit
+*   can reach from the target. The labels tell in advance whether the goal is in the same
+*   area: each unit size is a clearance class whose cells are the ones with an SDF value of
+*   at least the unit size, and each class keeps a union find of the areas of its cells,
+*   connected along rows and columns. Searches with jumping only step to cells within the
+*   SDF value of the cell they step from, they never cross walls, so they can't leave the
+*   area either.
+*
+*   After an SDF update, cells that became free join the areas next to them. A cell that
+*   became blocked may split its area: its free neighbors flood the area at the same pace
+*   until the floods meet. A flood that runs out of cells first has found a part that was
+*   cut off and only that part gets a new id, so small cut off parts and cells blocked in
+*   the open cost little, however large the area is.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "clearance_labels.h"
+
+#include <stdlib.h> // Required for: malloc, free, NULL
+
+// more blocked cells than this are cheaper to handle by labeling the class again
+#define CLEARANCE_MAX_SPLIT_CELLS 1024
+
+static const int areaNeighborX[4] = { -1, 1, 0, 0 };
+static const int areaNeighborY[4] = { 0, 0, -1, 1 };
+
+// follows the parents to the root without changing them, so searches on several threads
+// can look up labels at the same time
+static int FindArea(const int *areaParents, int area)
+{
+    while (areaParents[area] != area)
+    {
+        area = areaParents[area];
+    }
+    return area;
+}
+
+static void JoinAreas(int *areaParents, int area, int other)
+{
+    int root = FindArea(areaParents, area);
+    int otherRoot = FindArea(areaParents, other);
+    if (root < otherRoot)
+    {
+        areaParents[otherRoot] = root;
+    }
+    else if (otherRoot < root)
+    {
+        areaParents[root] = otherRoot;
+    }
+}
+
+// root of a cell in the union find of the first labeling pass, halving the path on the way
+static int FindCellRoot(int *cellParents, int cell)
+{
+    while (cellParents[cell] != cell)
+    {
+        cellParents[cell] = cellParents[cellParents[cell]];
+        cell = cellParents[cell];
+    }
+    return cell;
+}
+
+static void LabelClass(ClearanceLabels *labels, const PathGrid *grid, int classIndex)
+{
+    int gridWidth = grid->width;
+    int cellCount = labels->cellCount;
+    const unsigned short *sdfCells = grid->sdfCells;
+    int unitSize = classIndex + 1;
+    int *cellAreas = labels->cellAreas[classIndex];
+    int *areaParents = labels->areaParents[classIndex];
+
+    // the cells are joined with their free neighbors to the left and above. The root with
+    // the higher index is linked to the other one, so parents come before their children.
+    for (int cell = 0; cell < cellCount; cell++)
+    {
+        if (sdfCells[cell] < unitSize)
+        {
+            cellAreas[cell] = -1;
+            continue;
+        }
+        cellAreas[cell] = cell;
+        int neighbors[2] = { cell % gridWidth > 0 ? cell - 1 : -1, cell >= gridWidth ? cell - gridWidth : -1 };
+        for (int i = 0; i < 2; i++)
+        {
+            if (neighbors[i] < 0 || cellAreas[neighbors[i]] < 0)
+            {
+                continue;
+            }
+            int root = FindCellRoot(cellAreas, cell);
+            int neighborRoot = FindCellRoot(cellAreas, neighbors[i]);
+            if (root < neighborRoot)
+            {
+                cellAreas[neighborRoot] = root;
+            }
+            else if (neighborRoot < root)
+            {
+                cellAreas[root] = neighborRoot;
+            }
+        }
+    }
+
+    // the roots get the area ids and each other cell takes the id its parent already has
+    int areaCount = 0;
+    for (int cell = 0; cell < cellCount; cell++)
+    {
+        if (cellAreas[cell] == cell)
+        {
+            areaParents[areaCount] = areaCount;
+            cellAreas[cell] = areaCount++;
+        }
+        else if (cellAreas[cell] >= 0)
+        {
+            cellAreas[cell] = cellAreas[cellAreas[cell]];
+        }
+    }
+    labels->areaCounts[classIndex] = areaCount;
+}
+
+void PathGrid_enableClearanceLabels(PathGrid *grid, int classCount)
+{
+    PathGrid_disableClearanceLabels(grid);
+    int cellCount = grid->width * grid->height;
+    ClearanceLabels *labels = (ClearanceLabels *)RL_CALLOC(1, sizeof(ClearanceLabels));
+    labels->classCount = clamp(classCount, 1, CLEARANCE_MAX_CLASSES);
+    labels->cellCount = cellCount;
+    for (int i = 0; i < labels->classCount; i++)
+    {
+        labels->cellAreas[i] = (int *)RL_MALLOC(cellCount * sizeof(int));
+        labels->areaParents[i] = (int *)RL_MALLOC(cellCount * sizeof(int));
+    }
+    labels->cellFloods = (int *)RL_MALLOC(cellCount * sizeof(int));
+    labels->floodCells = (int *)RL_MALLOC(cellCount * sizeof(int));
+    for (int i = 0; i < cellCount; i++)
+    {
+        labels->cellFloods[i] = -1;
+    }
+    grid->clearanceLabels = labels;
+    // otherwise the labels are computed with the SDF
+    if (grid->sdfState != NULL)
+    {
+        ClearanceLabels_compute(grid);
+    }
+}
+
+void PathGrid_disableClearanceLabels(PathGrid *grid)
+{
+    ClearanceLabels *labels = grid->clearanceLabels;
+    if (labels == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < labels->classCount; i++)
+    {
+        RL_FREE(labels->cellAreas[i]);
+        RL_FREE(labels->areaParents[i]);
+    }
+    RL_FREE(labels->cellFloods);
+    RL_FREE(labels->floodCells);
+    RL_FREE(labels);
+    grid->clearanceLabels = NULL;
+}
+
+void ClearanceLabels_compute(PathGrid *grid)
+{
+    ClearanceLabels *labels = grid->clearanceLabels;
+    for (int i = 0; i < labels->classCount; i++)
+    {
+        LabelClass(labels, grid, i);
+    }
+}
+
+// floods the area from the seeds, which all belong to it, and gives the parts that turn out
+// to be cut off from the others new ids. Returns 0 if the class ran out of area ids.
+static int SplitArea(ClearanceLabels *labels, const PathGrid *grid, int classIndex, int area, const int *seeds, int seedCount, int *floodParents, int *floodSizes)
+{
+    int gridWidth = grid->width;
+    int *cellAreas = labels->cellAreas[classIndex];
+    int *areaParents = labels->areaParents[classIndex];
+    int *cellFloods = labels->cellFloods;
+    int *floodCells = labels->floodCells;
+
+    // each flood counts the cells it queued and didn't expand yet, floods that meet are
+    // joined and a flood without queued cells has reached all cells of its part
+    int head = 0;
+    int tail = 0;
+    int floodCount = 0;
+    for (int i = 0; i < seedCount; i++)
+    {
+        if (cellFloods[seeds[i]] < 0)
+        {
+            cellFloods[seeds[i]] = floodCount;
+            floodCells[tail++] = seeds[i];
+            floodParents[floodCount] = floodCount;
+            floodSizes[floodCount] = 1;
+            floodCount++;
+        }
+    }
+    int groupCount = floodCount;
+    int activeCount = floodCount;
+    while (groupCount > 1 && activeCount > 1)
+    {
+        int cell = floodCells[head++];
+        int flood = FindArea(floodParents, cellFloods[cell]);
+        floodSizes[flood]--;
+        int x = cell % gridWidth;
+        int y = cell / gridWidth;
+        for (int i = 0; i < 4; i++)
+        {
+            int nx = x + areaNeighborX[i];
+            int ny = y + areaNeighborY[i];
+            if (!PathGrid_contains(grid, nx, ny))
+            {
+                continue;
+            }
+            int neighbor = ny * gridWidth + nx;
+            if (cellAreas[neighbor] < 0 || FindArea(areaParents, cellAreas[neighbor]) != area)
+            {
+                continue;
+            }
+            if (cellFloods[neighbor] < 0)
+            {
+                cellFloods[neighbor] = flood;
+                floodCells[tail++] = neighbor;
+                floodSizes[flood]++;
+                continue;
+            }
+            // a finished flood can't be met, it would have queued this cell itself
+            int other = FindArea(floodParents, cellFloods[neighbor]);
+            if (other != flood)
+            {
+                floodParents[other] = flood;
+                floodSizes[flood] += floodSizes[other];
+                groupCount--;
+                activeCount--;
+            }
+        }
+        if (floodSizes[flood] == 0)
+        {
+            activeCount--;
+        }
+    }
+
+    // the last flood that is still running keeps the id, or the one of the first seed if
+    // all of them finished; the cells of the finished ones all are in floodCells
+    int success = 1;
+    if (groupCount > 1)
+    {
+        int keeper = FindArea(floodParents, 0);
+        for (int i = 0; i < floodCount; i++)
+        {
+            if (floodParents[i] == i && floodSizes[i] > 0)
+            {
+                keeper = i;
+            }
+        }
+        // the flood sizes of finished floods are reused for their new ids
+        for (int i = 0; i < floodCount; i++)
+        {
+            if (floodParents[i] == i && i != keeper)
+            {
+                if (labels->areaCounts[classIndex] == labels->cellCount)
+                {
+                    success = 0;
+                    break;
+                }
+                int newArea = labels->areaCounts[classIndex]++;
+                areaParents[newArea] = newArea;
+                floodSizes[i] = newArea;
+            }
+        }
+        for (int i = 0; i < tail && success; i++)
+        {
+            int flood = FindArea(floodParents, cellFloods[floodCells[i]]);
+            if (flood != keeper)
+            {
+                cellAreas[floodCells[i]] = floodSizes[flood];
+            }
+        }
+    }
+
+    for (int i = 0; i < tail; i++)
+    {
+        cellFloods[floodCells[i]] = -1;
+    }
+    return success;
+}
+
+// returns 0 if the class has to be labeled again
+static int UpdateClass(ClearanceLabels *labels, const PathGrid *grid, int classIndex, const int *changedCells, int changedCount, int *cells)
+{
+    int gridWidth = grid->width;
+    const unsigned short *sdfCells = grid->sdfCells;
+    int unitSize = classIndex + 1;
+    int *cellAreas = labels->cellAreas[classIndex];
+    int *areaParents = labels->areaParents[classIndex];
+
+    // the free neighbors of the blocked cells are the seeds of the floods that check whether
+    // the blocked cells split their areas
+    int blockedCount = 0;
+    for (int i = 0; i < changedCount; i++)
+    {
+        int cell = changedCells[i];
+        if (cellAreas[cell] >= 0 && sdfCells[cell] < unitSize)
+        {
+            cellAreas[cell] = -1;
+            cells[blockedCount++] = cell;
+        }
+    }
+    if (blockedCount > CLEARANCE_MAX_SPLIT_CELLS)
+    {
+        return 0;
+    }
+    if (blockedCount > 0)
+    {
+        int seedCount = 0;
+        int *seeds = (int *)RL_MALLOC(blockedCount * 4 * sizeof(int));
+        int *seedAreas = (int *)RL_MALLOC(blockedCount * 4 * sizeof(int));
+        int *floodParents = (int *)RL_MALLOC(blockedCount * 4 * sizeof(int));
+        int *floodSizes = (int *)RL_MALLOC(blockedCount * 4 * sizeof(int));
+        for (int i = 0; i < blockedCount; i++)
+        {
+            int x = cells[i] % gridWidth;
+            int y = cells[i] / gridWidth;
+            for (int j = 0; j < 4; j++)
+            {
+                int nx = x + areaNeighborX[j];
+                int ny = y + areaNeighborY[j];
+                if (PathGrid_contains(grid, nx, ny) && cellAreas[ny * gridWidth + nx] >= 0)
+                {
+                    seeds[seedCount] = ny * gridWidth + nx;
+                    seedAreas[seedCount] = FindArea(areaParents, cellAreas[seeds[seedCount]]);
+                    seedCount++;
+                }
+            }
+        }
+
+        // the seeds are checked area by area, moving the seeds of one area to the front
+        int success = 1;
+        int first = 0;
+        while (first < seedCount && success)
+        {
+            int area = seedAreas[first];
+            int count = first + 1;
+            for (int i = first + 1; i < seedCount; i++)
+            {
+                if (seedAreas[i] == area)
+                {
+                    int seed = seeds[i];
+                    seeds[i] = seeds[count];
+                    seedAreas[i] = seedAreas[count];
+                    seeds[count] = seed;
+                    seedAreas[count] = area;
+                    count++;
+                }
+            }
+            success = SplitArea(labels, grid, classIndex, area, seeds + first, count - first, floodParents, floodSizes);
+            first = count;
+        }
+        RL_FREE(seeds);
+        RL_FREE(seedAreas);
+        RL_FREE(floodParents);
+        RL_FREE(floodSizes);
+        if (!success)
+        {
+            return 0;
+        }
+    }
+
+    // freed cells get new areas first, so freed cells next to each other are joined too
+    int freedCount = 0;
+    for (int i = 0; i < changedCount; i++)
+    {
+        int cell = changedCells[i];
+        if (cellAreas[cell] < 0 && sdfCells[cell] >= unitSize)
+        {
+            if (labels->areaCounts[classIndex] == labels->cellCount)
+            {
+                return 0;
+            }
+            int area = labels->areaCounts[classIndex]++;
+            areaParents[area] = area;
+            cellAreas[cell] = area;
+            cells[freedCount++] = cell;
+        }
+    }
+    for (int i = 0; i < freedCount; i++)
+    {
+        int x = cells[i] % gridWidth;
+        int y = cells[i] / gridWidth;
+        for (int j = 0; j < 4; j++)
+        {
+            int nx = x + areaNeighborX[j];
+            int ny = y + areaNeighborY[j];
+            if (PathGrid_contains(grid, nx, ny) && cellAreas[ny * gridWidth + nx] >= 0)
+            {
+                JoinAreas(areaParents, cellAreas[cells[i]], cellAreas[ny * gridWidth + nx]);
+            }
+        }
+    }
+    return 1;
+}
+
+void ClearanceLabels_update(PathGrid *grid, const int *changedCells, int changedCount)
+{
+    ClearanceLabels *labels = grid->clearanceLabels;
+    int *cells = (int *)RL_MALLOC(changedCount * sizeof(int));
+    for (int i = 0; i < labels->classCount; i++)
+    {
+        if (!UpdateClass(labels, grid, i, changedCells, changedCount, cells))
+        {
+            LabelClass(labels, grid, i);
+        }
+    }
+    RL_FREE(cells);
+}
+
+int PathGrid_isReachable(const PathGrid *grid, int unitSize, int startX, int startY, int targetX, int targetY)
+{
+    const ClearanceLabels *labels = grid->clearanceLabels;
+    if (labels == NULL || unitSize < 1 || unitSize > labels->classCount || (startX == targetX && startY == targetY))
+    {
+        return 1;
+    }
+    const int *cellAreas = labels->cellAreas[unitSize - 1];
+    const int *areaParents = labels->areaParents[unitSize - 1];
+    int gridWidth = grid->width;
+    int startCell = startY * gridWidth + startX;
+    int targetCell = targetY * gridWidth + targetX;
+    // the searches never step onto cells that are too close to a wall
+    if (cellAreas[startCell] < 0)
+    {
+        return 0;
+    }
+    int startArea = FindArea(areaParents, cellAreas[startCell]);
+    if (cellAreas[targetCell] >= 0)
+    {
+        return FindArea(areaParents, cellAreas[targetCell]) == startArea;
+    }
+
+    // the search still starts at a target that is too close to a wall, and from there it
+    // steps onto the neighbors at a distance of 1
+    for (int i = 0; i < 4; i++)
+    {
+        int x = targetX + areaNeighborX[i];
+        int y = targetY + areaNeighborY[i];
+        if (PathGrid_contains(grid, x, y) && cellAreas[y * gridWidth + x] >= 0 &&
+            FindArea(areaParents, cellAreas[y * gridWidth + x]) == startArea)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
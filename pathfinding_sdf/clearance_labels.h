@@ -0,0 +1,57 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - clearance connectivity labels
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef CLEARANCE_LABELS_H
+#define CLEARANCE_LABELS_H
+
+#include "pathfinding.h"
+
+// the largest unit size that can have labels
+#define CLEARANCE_MAX_CLASSES 8
+
+// the connected areas of the cells a unit of each size can stand on. A unit can only reach
+// the cells in the area it stands in, so a search for a target in another area can be
+// rejected before it floods all of its own area.
+typedef struct ClearanceLabels
+{
+    // unit sizes from 1 to classCount have labels
+    int classCount;
+    int cellCount;
+    // per class and cell the id of its area, -1 for cells that are too close to a wall for
+    // the unit size
+    int *cellAreas[CLEARANCE_MAX_CLASSES];
+    // per class a union find over the area ids: areas that got connected by freed cells
+    // point to the same root. Ids are not reused until the class is labeled again.
+    int *areaParents[CLEARANCE_MAX_CLASSES];
+    int areaCounts[CLEARANCE_MAX_CLASSES];
+    // scratch of the split check: the flood that reached each cell, -1 if none did, and
+    // the reached cells in the order they were reached
+    int *cellFloods;
+    int *floodCells;
+} ClearanceLabels;
+
+// labels the areas of unit sizes up to classCount from now on: ComputeSDF labels all cells
+// again and UpdateSDFCells updates the labels of the changed cells. The labels are computed
+// right away if the grid has an SDF already.
+void PathGrid_enableClearanceLabels(PathGrid *grid, int classCount);
+// frees the labels, PathGrid_destroy calls this
+void PathGrid_disableClearanceLabels(PathGrid *grid);
+
+// called by ComputeSDF and UpdateSDFCells
+void ClearanceLabels_compute(PathGrid *grid);
+void ClearanceLabels_update(PathGrid *grid, const int *changedCells, int changedCount);
+
+// 0 if a search for a unit of the given size that starts at the target can't reach the
+// start, 1 if it may. Grids without labels and unit sizes without a class always return 1.
+int PathGrid_isReachable(const PathGrid *grid, int unitSize, int startX, int startY, int targetX, int targetY);
+
+#endif
@@ -0,0 +1,146 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - shared flow fields
+*
+*   Agent_findPath searches from the target to the start and doesn't stop early, so the
+*   map it produces holds the path from every reachable cell to the target. Agents that
+*   share a target, unit size and wall factor would all produce the same map. The flow field
+*   cache searches it once per such class and the agents only follow the parents.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "flow_field.h"
+
+#include <stdlib.h> // Required for: malloc, free
+
+FlowFieldCache FlowFieldCache_init(PathGrid *grid, int capacity)
+{
+    FlowFieldCache cache = { 0 };
+    cache.grid = grid;
+    cache.fields = (FlowField *)RL_CALLOC(capacity, sizeof(FlowField));
+    cache.capacity = capacity;
+    return cache;
+}
+
+void FlowFieldCache_free(FlowFieldCache *cache)
+{
+    for (int i = 0; i < cache->count; i++)
+    {
+        Agent_free(&cache->fields[i].search);
+    }
+    RL_FREE(cache->fields);
+    cache->fields = NULL;
+    cache->count = 0;
+    cache->capacity = 0;
+}
+
+const FlowField *FlowFieldCache_get(FlowFieldCache *cache, int targetX, int targetY, int unitSize, int wallFactor, int enableJumping)
+{
+    FlowField *field = NULL;
+    for (int i = 0; i < cache->count; i++)
+    {
+        FlowField *candidate = &cache->fields[i];
+        if (candidate->targetX == targetX && candidate->targetY == targetY && candidate->unitSize == unitSize &&
+            candidate->wallFactor == wallFactor && candidate->enableJumping == enableJumping)
+        {
+            field = candidate;
+            break;
+        }
+    }
+
+    if (field == NULL)
+    {
+        if (cache->count < cache->capacity)
+        {
+            field = &cache->fields[cache->count++];
+            field->search = Agent_init(cache->grid, targetX, targetY, unitSize, targetX, targetY, wallFactor, NULL, 0, WHITE);
+        }
+        else
+        {
+            // replace the field that wasn't used for the longest time
+            field = &cache->fields[0];
+            for (int i = 1; i < cache->count; i++)
+            {
+                if (cache->fields[i].lastUsed < field->lastUsed)
+                {
+                    field = &cache->fields[i];
+                }
+            }
+        }
+        field->targetX = targetX;
+        field->targetY = targetY;
+        field->unitSize = unitSize;
+        field->wallFactor = wallFactor;
+        field->enableJumping = enableJumping;
+        // forces the search below
+        field->sdfVersion = cache->grid->sdfVersion - 1;
+    }
+
+    field->lastUsed = ++cache->useCounter;
+    if (field->sdfVersion == cache->grid->sdfVersion)
+    {
+        cache->hitCount++;
+        return field;
+    }
+
+    cache->missCount++;
+    Agent *search = &field->search;
+    search->targetX = targetX;
+    search->targetY = targetY;
+    search->startX = targetX;
+    search->startY = targetY;
+    search->unitSize = unitSize;
+    search->wallFactor = wallFactor;
+    Agent_findPath(search, enableJumping);
+    field->sdfVersion = cache->grid->sdfVersion;
+    return field;
+}
+
+const FlowField *FlowFieldCache_getForAgent(FlowFieldCache *cache, const Agent *agent, int enableJumping)
+{
+    return FlowFieldCache_get(cache, agent->targetX, agent->targetY, agent->unitSize, agent->wallFactor, enableJumping);
+}
+
+int FlowField_nextCell(const FlowField *field, int x, int y, int *nextX, int *nextY)
+{
+    int gridWidth = field->search.grid->width;
+    unsigned int parent = PathMap_parent(&field->search.map, y * gridWidth + x);
+    if (parent == PATH_NO_PARENT)
+    {
+        return 0;
+    }
+    *nextX = parent % gridWidth;
+    *nextY = parent / gridWidth;
+    return 1;
+}
+
+void Agent_followFlowField(Agent *agent, const FlowField *field)
+{
+    agent->pathCount = ExtractPath(agent->grid, &field->search.map, agent->startX, agent->startY, field->targetX, field->targetY, agent->path);
+    agent->pathScore = PathMap_score(&field->search.map, agent->startY * agent->grid->width + agent->startX);
+    agent->expandedCount = 0;
+}
@@ -0,0 +1,67 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - shared flow fields
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include "pathfinding.h"
+
+// the search result of a target for all agents of the same unit size and wall factor:
+// the scores of the map are the integration field, the parent of each cell is the
+// neighbor that leads downhill towards the target
+typedef struct FlowField
+{
+    int targetX, targetY;
+    int unitSize;
+    int wallFactor;
+    int enableJumping;
+    // sdfVersion the field was searched with
+    int sdfVersion;
+    // the agent running the search, its map is the field
+    Agent search;
+    // for picking the field to replace when the cache is full
+    unsigned int lastUsed;
+} FlowField;
+
+// the flow fields of one grid
+typedef struct FlowFieldCache
+{
+    PathGrid *grid;
+    FlowField *fields;
+    int count;
+    int capacity;
+    unsigned int useCounter;
+    // number of requests that were answered from the cache / needed a search
+    int hitCount;
+    int missCount;
+} FlowFieldCache;
+
+FlowFieldCache FlowFieldCache_init(PathGrid *grid, int capacity);
+void FlowFieldCache_free(FlowFieldCache *cache);
+
+// returns the flow field for the target and agent class. It is only searched if it is not
+// cached yet or the SDF changed since it was searched; when the cache is full, the least
+// recently used field is replaced.
+const FlowField *FlowFieldCache_get(FlowFieldCache *cache, int targetX, int targetY, int unitSize, int wallFactor, int enableJumping);
+
+// the flow field for the agent's target and class
+const FlowField *FlowFieldCache_getForAgent(FlowFieldCache *cache, const Agent *agent, int enableJumping);
+
+// the next cell to move to from the given cell, returns 0 if the target can't be reached
+// from there or the cell is the target
+int FlowField_nextCell(const FlowField *field, int x, int y, int *nextX, int *nextY);
+
+// fills the path of the agent by following the flow field from the agent's start, the
+// field has to belong to the agent's grid and target
+void Agent_followFlowField(Agent *agent, const FlowField *field);
+
+#endif
@@ -0,0 +1,660 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - hierarchical pathfinding
+*
+*   The flat search visits every cell it can reach, so its cost grows with the map area.
+*   The hierarchical graph splits the map into clusters and only keeps the cells where a
+*   unit can cross from one cluster into the next. Whether a unit fits through a border
+*   is decided by the SDF value, just like in the flat search, so narrow passages don't
+*   produce entrances for big units. A query searches the abstract graph of these entrances
+*   and only searches cells inside the clusters the path runs through.
+*
+*   The path is not always the shortest one: it has to pass the borders at the entrances.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "hierarchical_graph.h"
+#include "sdf.h"
+
+#include <stdlib.h> // Required for: malloc, free, qsort, abs
+#include <string.h> // Required for: memset
+#include <math.h> // Required for: sqrtf
+
+// a cell on one side of a cluster border and its neighbor on the other side
+typedef struct HierarchicalTransition
+{
+    int cellA;
+    int cellB;
+} HierarchicalTransition;
+
+typedef struct HierarchicalBuildNode
+{
+    int cluster;
+    int cell;
+} HierarchicalBuildNode;
+
+static int ClusterOf(const HierarchicalGraph *graph, int x, int y)
+{
+    return (y / graph->clusterSize) * graph->clustersX + x / graph->clusterSize;
+}
+
+static int CompareBuildNodes(const void *a, const void *b)
+{
+    const HierarchicalBuildNode *nodeA = (const HierarchicalBuildNode *)a;
+    const HierarchicalBuildNode *nodeB = (const HierarchicalBuildNode *)b;
+    if (nodeA->cluster != nodeB->cluster)
+    {
+        return nodeA->cluster < nodeB->cluster ? -1 : 1;
+    }
+    return nodeA->cell < nodeB->cell ? -1 : (nodeA->cell > nodeB->cell);
+}
+
+static int CompareOffsets(const void *a, const void *b)
+{
+    return ((const NeighborOffset *)a)->distance - ((const NeighborOffset *)b)->distance;
+}
+
+//------------------------------------------------------------------------------------
+// searches inside a cluster
+//------------------------------------------------------------------------------------
+static int LocalIndex(const HierarchicalGraph *graph, int cluster, int x, int y)
+{
+    int x0 = cluster % graph->clustersX * graph->clusterSize;
+    int y0 = cluster / graph->clustersX * graph->clusterSize;
+    return (y - y0) * graph->clusterSize + x - x0;
+}
+
+// Dijkstra with the same steps and scores as Agent_findPath, limited to the cells of one
+// cluster. The scores of the reached cells are stored in localScores, starting with 1 at
+// the searched cell. Stops when the stop cell is taken from the queue, a stopX of -1
+// searches the whole cluster.
+static void LocalSearch(HierarchicalGraph *graph, int cluster, int fromX, int fromY, int stopX, int stopY)
+{
+    const PathGrid *grid = graph->grid;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    const unsigned short *sdfCells = grid->sdfCells;
+    int size = graph->clusterSize;
+    int x0 = cluster % graph->clustersX * size;
+    int y0 = cluster / graph->clustersX * size;
+    int x1 = x0 + size < gridWidth ? x0 + size : gridWidth;
+    int y1 = y0 + size < gridHeight ? y0 + size : gridHeight;
+    int unitSize = graph->unitSize;
+    int wallFactor = graph->wallFactor;
+    int *scores = graph->localScores;
+    int *from = graph->localFrom;
+    PathHeap *queue = &graph->localQueue;
+
+    memset(scores, 0, size * size * sizeof(int));
+    int start = LocalIndex(graph, cluster, fromX, fromY);
+    int stop = stopX < 0 ? -1 : LocalIndex(graph, cluster, stopX, stopY);
+    scores[start] = 1;
+    from[start] = -1;
+    PathHeap_push(queue, start, 1);
+
+    while (queue->count > 0)
+    {
+        int local = PathHeap_pop(queue);
+        if (local == stop)
+        {
+            break;
+        }
+
+        int x = x0 + local % size;
+        int y = y0 + local / size;
+        int cellSdf = sdfCells[y * gridWidth + x];
+        int maxDistance = graph->enableJumping ? PathMaxStepDistance(cellSdf, unitSize) : 1;
+
+        // the offsets are sorted by distance, so the loop ends at the first one too far away
+        for (int i = 0; i < neighborOffsetCount && graph->offsets[i].distance <= maxDistance; i++)
+        {
+            int nextX = x + graph->offsets[i].x;
+            int nextY = y + graph->offsets[i].y;
+            if (nextX < x0 || nextX >= x1 || nextY < y0 || nextY >= y1)
+            {
+                continue;
+            }
+
+            int nextSdf = sdfCells[nextY * gridWidth + nextX];
+            if (nextSdf < unitSize)
+            {
+                continue;
+            }
+
+            int next = (nextY - y0) * size + nextX - x0;
+            int score = scores[local] + PathStepScore(cellSdf, nextSdf, graph->offsets[i].distance, wallFactor);
+            if (scores[next] == 0 || score < scores[next])
+            {
+                scores[next] = score;
+                from[next] = local;
+                PathHeap_push(queue, next, score);
+            }
+        }
+    }
+    PathHeap_clear(queue);
+}
+
+//------------------------------------------------------------------------------------
+// building the graph
+//------------------------------------------------------------------------------------
+
+// scans length cells of a cluster border, starting at x, y in the direction dx, dy; the
+// cells on the other side of the border are at x + dy, y + dx. Every stretch of cells where
+// the unit fits on both sides gets an entrance, long stretches get one every
+// HIERARCHICAL_ENTRANCE_SPACING cells
+static void AddEntrances(const PathGrid *grid, int x, int y, int dx, int dy, int length, int unitSize,
+    HierarchicalTransition **transitions, int *transitionCount, int *transitionCapacity)
+{
+    int gridWidth = grid->width;
+    const unsigned short *sdfCells = grid->sdfCells;
+    int runStart = -1;
+    for (int i = 0; i <= length; i++)
+    {
+        int open = 0;
+        if (i < length)
+        {
+            int cellA = (y + dy * i) * gridWidth + x + dx * i;
+            int cellB = cellA + dy + dx * gridWidth;
+            open = sdfCells[cellA] >= unitSize && sdfCells[cellB] >= unitSize;
+        }
+
+        if (open && runStart < 0)
+        {
+            runStart = i;
+        }
+        else if (!open && runStart >= 0)
+        {
+            int runLength = i - runStart;
+            int pieceCount = (runLength + HIERARCHICAL_ENTRANCE_SPACING - 1) / HIERARCHICAL_ENTRANCE_SPACING;
+            for (int piece = 0; piece < pieceCount; piece++)
+            {
+                // the middle of the piece, for single entrances that's the middle of the passage
+                int middle = runStart + (runLength * piece / pieceCount + runLength * (piece + 1) / pieceCount) / 2;
+                if (*transitionCount == *transitionCapacity)
+                {
+                    *transitionCapacity *= 2;
+                    *transitions = (HierarchicalTransition *)RL_REALLOC(*transitions, *transitionCapacity * sizeof(HierarchicalTransition));
+                }
+                int cellA = (y + dy * middle) * gridWidth + x + dx * middle;
+                (*transitions)[(*transitionCount)++] = (HierarchicalTransition){ cellA, cellA + dy + dx * gridWidth };
+            }
+            runStart = -1;
+        }
+    }
+}
+
+static int FindNode(const HierarchicalGraph *graph, int cell)
+{
+    const PathGrid *grid = graph->grid;
+    int gridWidth = grid->width;
+    int cluster = ClusterOf(graph, cell % gridWidth, cell / gridWidth);
+    int low = graph->clusterFirstNode[cluster];
+    int high = graph->clusterFirstNode[cluster + 1] - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        int middleCell = graph->nodes[middle].y * gridWidth + graph->nodes[middle].x;
+        if (middleCell == cell)
+        {
+            return middle;
+        }
+        if (middleCell < cell)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return -1;
+}
+
+HierarchicalGraph HierarchicalGraph_build(PathGrid *grid, int clusterSize, int unitSize, int wallFactor, int enableJumping)
+{
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    const unsigned short *sdfCells = grid->sdfCells;
+    HierarchicalGraph graph = { 0 };
+    graph.grid = grid;
+    graph.clusterSize = clusterSize;
+    graph.clustersX = (gridWidth + clusterSize - 1) / clusterSize;
+    graph.clustersY = (gridHeight + clusterSize - 1) / clusterSize;
+    graph.unitSize = unitSize;
+    graph.wallFactor = wallFactor;
+    graph.enableJumping = enableJumping;
+    graph.sdfVersion = grid->sdfVersion;
+    int clusterCount = graph.clustersX * graph.clustersY;
+
+    graph.offsets = (NeighborOffset *)RL_MALLOC(neighborOffsetCount * sizeof(NeighborOffset));
+    for (int i = 0; i < neighborOffsetCount; i++)
+    {
+        graph.offsets[i] = neighborOffsets[i];
+    }
+    qsort(graph.offsets, neighborOffsetCount, sizeof(NeighborOffset), CompareOffsets);
+
+    graph.localScores = (int *)RL_MALLOC(clusterSize * clusterSize * sizeof(int));
+    graph.localFrom = (int *)RL_MALLOC(clusterSize * clusterSize * sizeof(int));
+    graph.localQueue = PathHeap_init(clusterSize * clusterSize);
+
+    // entrances on the vertical borders, then on the horizontal borders
+    int transitionCount = 0;
+    int transitionCapacity = 256;
+    HierarchicalTransition *transitions = (HierarchicalTransition *)RL_MALLOC(transitionCapacity * sizeof(HierarchicalTransition));
+    for (int clusterY = 0; clusterY < graph.clustersY; clusterY++)
+    {
+        int y = clusterY * clusterSize;
+        int length = y + clusterSize < gridHeight ? clusterSize : gridHeight - y;
+        for (int clusterX = 0; clusterX < graph.clustersX - 1; clusterX++)
+        {
+            AddEntrances(grid, (clusterX + 1) * clusterSize - 1, y, 0, 1, length, unitSize, &transitions, &transitionCount, &transitionCapacity);
+        }
+    }
+    for (int clusterY = 0; clusterY < graph.clustersY - 1; clusterY++)
+    {
+        for (int clusterX = 0; clusterX < graph.clustersX; clusterX++)
+        {
+            int x = clusterX * clusterSize;
+            int length = x + clusterSize < gridWidth ? clusterSize : gridWidth - x;
+            AddEntrances(grid, x, (clusterY + 1) * clusterSize - 1, 1, 0, length, unitSize, &transitions, &transitionCount, &transitionCapacity);
+        }
+    }
+
+    // both cells of each transition are nodes, sorted by cluster; a cell in the corner of a
+    // cluster can be part of two transitions but is only one node
+    HierarchicalBuildNode *buildNodes = (HierarchicalBuildNode *)RL_MALLOC((transitionCount * 2 + 1) * sizeof(HierarchicalBuildNode));
+    for (int i = 0; i < transitionCount; i++)
+    {
+        int cellA = transitions[i].cellA;
+        int cellB = transitions[i].cellB;
+        buildNodes[i * 2] = (HierarchicalBuildNode){ ClusterOf(&graph, cellA % gridWidth, cellA / gridWidth), cellA };
+        buildNodes[i * 2 + 1] = (HierarchicalBuildNode){ ClusterOf(&graph, cellB % gridWidth, cellB / gridWidth), cellB };
+    }
+    qsort(buildNodes, transitionCount * 2, sizeof(HierarchicalBuildNode), CompareBuildNodes);
+
+    graph.nodes = (HierarchicalNode *)RL_MALLOC((transitionCount * 2 + 1) * sizeof(HierarchicalNode));
+    graph.clusterFirstNode = (int *)RL_CALLOC(clusterCount + 1, sizeof(int));
+    for (int i = 0; i < transitionCount * 2; i++)
+    {
+        if (i > 0 && buildNodes[i].cell == buildNodes[i - 1].cell)
+        {
+            continue;
+        }
+        int cell = buildNodes[i].cell;
+        graph.nodes[graph.nodeCount++] = (HierarchicalNode){ .x = cell % gridWidth, .y = cell / gridWidth, .cluster = buildNodes[i].cluster };
+        graph.clusterFirstNode[buildNodes[i].cluster + 1]++;
+    }
+    RL_FREE(buildNodes);
+    for (int i = 0; i < clusterCount; i++)
+    {
+        graph.clusterFirstNode[i + 1] += graph.clusterFirstNode[i];
+    }
+
+    // transitions to the other side of the border, a node can be on up to 4 borders
+    int *borderNodes = (int *)RL_MALLOC((graph.nodeCount * 4 + 1) * sizeof(int));
+    int *borderCounts = (int *)RL_CALLOC(graph.nodeCount + 1, sizeof(int));
+    for (int i = 0; i < transitionCount; i++)
+    {
+        int nodeA = FindNode(&graph, transitions[i].cellA);
+        int nodeB = FindNode(&graph, transitions[i].cellB);
+        borderNodes[nodeA * 4 + borderCounts[nodeA]++] = nodeB;
+        borderNodes[nodeB * 4 + borderCounts[nodeB]++] = nodeA;
+    }
+    RL_FREE(transitions);
+
+    int maxEdgeCount = transitionCount * 2;
+    int maxClusterNodeCount = 0;
+    for (int i = 0; i < clusterCount; i++)
+    {
+        int count = graph.clusterFirstNode[i + 1] - graph.clusterFirstNode[i];
+        maxEdgeCount += count * (count - 1);
+        maxClusterNodeCount = count > maxClusterNodeCount ? count : maxClusterNodeCount;
+    }
+    graph.edges = (HierarchicalEdge *)RL_MALLOC((maxEdgeCount + 1) * sizeof(HierarchicalEdge));
+
+    // the edges inside a cluster are the scores of a search from each of its nodes
+    for (int cluster = 0; cluster < clusterCount; cluster++)
+    {
+        int firstNode = graph.clusterFirstNode[cluster];
+        int endNode = graph.clusterFirstNode[cluster + 1];
+        for (int i = firstNode; i < endNode; i++)
+        {
+            HierarchicalNode *node = &graph.nodes[i];
+            node->firstEdge = graph.edgeCount;
+            int cellSdf = sdfCells[node->y * gridWidth + node->x];
+            for (int j = 0; j < borderCounts[i]; j++)
+            {
+                HierarchicalNode *other = &graph.nodes[borderNodes[i * 4 + j]];
+                int cost = PathStepScore(cellSdf, sdfCells[other->y * gridWidth + other->x], 1, wallFactor);
+                graph.edges[graph.edgeCount++] = (HierarchicalEdge){ borderNodes[i * 4 + j], cost };
+            }
+
+            LocalSearch(&graph, cluster, node->x, node->y, -1, -1);
+            for (int j = firstNode; j < endNode; j++)
+            {
+                int score = graph.localScores[LocalIndex(&graph, cluster, graph.nodes[j].x, graph.nodes[j].y)];
+                if (j != i && score > 0)
+                {
+                    graph.edges[graph.edgeCount++] = (HierarchicalEdge){ j, score - 1 };
+                }
+            }
+            node->edgeCount = graph.edgeCount - node->firstEdge;
+        }
+    }
+    RL_FREE(borderNodes);
+    RL_FREE(borderCounts);
+
+    // the abstract search uses more nodes for the cells of a query, see queryCells
+    int searchNodeCount = graph.nodeCount + HIERARCHICAL_QUERY_NODES;
+    graph.nodeScores = (int *)RL_MALLOC(searchNodeCount * sizeof(int));
+    graph.nodeFrom = (int *)RL_MALLOC(searchNodeCount * sizeof(int));
+    graph.nodeStamps = (unsigned int *)RL_CALLOC(searchNodeCount, sizeof(unsigned int));
+    graph.nodeQueue = PathHeap_init(searchNodeCount);
+    graph.startCosts = (int *)RL_MALLOC((maxClusterNodeCount + 1) * sizeof(int));
+    graph.abstractPath = (int *)RL_MALLOC(searchNodeCount * sizeof(int));
+    return graph;
+}
+
+void HierarchicalGraph_free(HierarchicalGraph *graph)
+{
+    RL_FREE(graph->nodes);
+    RL_FREE(graph->edges);
+    RL_FREE(graph->clusterFirstNode);
+    RL_FREE(graph->offsets);
+    RL_FREE(graph->nodeScores);
+    RL_FREE(graph->nodeFrom);
+    RL_FREE(graph->nodeStamps);
+    PathHeap_free(&graph->nodeQueue);
+    RL_FREE(graph->startCosts);
+    RL_FREE(graph->localScores);
+    RL_FREE(graph->localFrom);
+    PathHeap_free(&graph->localQueue);
+    RL_FREE(graph->abstractPath);
+    *graph = (HierarchicalGraph){ 0 };
+}
+
+void HierarchicalGraph_update(HierarchicalGraph *graph)
+{
+    if (graph->sdfVersion == graph->grid->sdfVersion)
+    {
+        return;
+    }
+
+    // the entrances and the costs between them depend on the SDF of every cluster, a wall
+    // in one cluster can also close or open an entrance of its neighbors
+    HierarchicalGraph old = *graph;
+    *graph = HierarchicalGraph_build(old.grid, old.clusterSize, old.unitSize, old.wallFactor, old.enableJumping);
+    HierarchicalGraph_free(&old);
+}
+
+//------------------------------------------------------------------------------------
+// queries
+//------------------------------------------------------------------------------------
+
+// lowers the score of a node of the abstract search. The queue is sorted by the score plus
+// the distance to the start that no path can undercut: every step costs at least its
+// distance, and without jumping the steps only go along the axes. The distance is weighed
+// a bit more, so among the many nodes with nearly the same estimate the ones closer to the
+// start come first - this makes the path up to 1/16 more expensive than the best one
+// through the graph, but visits only a fraction of the nodes
+static void RelaxNode(HierarchicalGraph *graph, int node, int score, int from, int startX, int startY)
+{
+    const PathGrid *grid = graph->grid;
+    int gridWidth = grid->width;
+    if (graph->nodeStamps[node] == graph->stamp && graph->nodeScores[node] <= score)
+    {
+        return;
+    }
+    graph->nodeStamps[node] = graph->stamp;
+    graph->nodeScores[node] = score;
+    graph->nodeFrom[node] = from;
+
+    int cell = node < graph->nodeCount ? graph->nodes[node].y * gridWidth + graph->nodes[node].x : graph->queryCells[node - graph->nodeCount];
+    int dx = cell % gridWidth - startX;
+    int dy = cell / gridWidth - startY;
+    int distance = graph->enableJumping ? (int)sqrtf((float)(dx * dx + dy * dy)) : abs(dx) + abs(dy);
+    PathHeap_push(&graph->nodeQueue, node, score + distance + distance / 16);
+}
+
+// searches the cluster of a cell from that cell and queues the nodes of the cluster, and the
+// start if it is in the same cluster
+static void SeedCluster(HierarchicalGraph *graph, int node, int x, int y, int startX, int startY)
+{
+    int cluster = ClusterOf(graph, x, y);
+    int baseScore = graph->nodeScores[node] - 1;
+    LocalSearch(graph, cluster, x, y, -1, -1);
+    for (int i = graph->clusterFirstNode[cluster]; i < graph->clusterFirstNode[cluster + 1]; i++)
+    {
+        int score = graph->localScores[LocalIndex(graph, cluster, graph->nodes[i].x, graph->nodes[i].y)];
+        if (score > 0)
+        {
+            RelaxNode(graph, i, baseScore + score, node, startX, startY);
+        }
+    }
+    if (cluster == ClusterOf(graph, startX, startY))
+    {
+        int score = graph->localScores[LocalIndex(graph, cluster, startX, startY)];
+        if (score > 0)
+        {
+            RelaxNode(graph, graph->nodeCount, baseScore + score, node, startX, startY);
+        }
+    }
+}
+
+int HierarchicalGraph_findAbstractPath(HierarchicalGraph *graph, int startX, int startY, int targetX, int targetY)
+{
+    HierarchicalGraph_update(graph);
+    const PathGrid *grid = graph->grid;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    const unsigned short *sdfCells = grid->sdfCells;
+    graph->abstractPathCount = 0;
+    graph->expandedCount = 0;
+    graph->pathScore = 0;
+    if (sdfCells[startY * gridWidth + startX] < graph->unitSize)
+    {
+        return 0;
+    }
+
+    graph->stamp++;
+    if (graph->stamp == 0)
+    {
+        memset(graph->nodeStamps, 0, (graph->nodeCount + HIERARCHICAL_QUERY_NODES) * sizeof(unsigned int));
+        graph->stamp = 1;
+    }
+
+    // like Agent_findPath, the search runs from the target to the start
+    int startNode = graph->nodeCount;
+    int targetNode = graph->nodeCount + 1;
+    int startCluster = ClusterOf(graph, startX, startY);
+    graph->queryCells[0] = startY * gridWidth + startX;
+    graph->queryCells[1] = targetY * gridWidth + targetX;
+    graph->nodeStamps[targetNode] = graph->stamp;
+    graph->nodeScores[targetNode] = 1;
+    graph->nodeFrom[targetNode] = -1;
+
+    // costs from the nodes of the start cluster to the start. They are searched from the
+    // start, which gives the same costs unless jumping is enabled: jump distances depend on
+    // the cell a jump starts from, so the costs are only an estimate then
+    int firstStartNode = graph->clusterFirstNode[startCluster];
+    int endStartNode = graph->clusterFirstNode[startCluster + 1];
+    LocalSearch(graph, startCluster, startX, startY, -1, -1);
+    for (int i = firstStartNode; i < endStartNode; i++)
+    {
+        graph->startCosts[i - firstStartNode] = graph->localScores[LocalIndex(graph, startCluster, graph->nodes[i].x, graph->nodes[i].y)] - 1;
+    }
+
+    SeedCluster(graph, targetNode, targetX, targetY, startX, startY);
+
+    // a target the unit doesn't fit on is left through its direct neighbors, which can be in
+    // the neighbor cluster without being an entrance
+    int targetSdf = sdfCells[targetY * gridWidth + targetX];
+    if (targetSdf < graph->unitSize)
+    {
+        const int neighbors[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+        for (int i = 0; i < 4; i++)
+        {
+            int x = targetX + neighbors[i][0];
+            int y = targetY + neighbors[i][1];
+            if (x < 0 || x >= gridWidth || y < 0 || y >= gridHeight || sdfCells[y * gridWidth + x] < graph->unitSize ||
+                ClusterOf(graph, x, y) == ClusterOf(graph, targetX, targetY))
+            {
+                continue;
+            }
+            int node = targetNode + 1 + i;
+            graph->queryCells[node - graph->nodeCount] = y * gridWidth + x;
+            graph->nodeStamps[node] = graph->stamp;
+            graph->nodeScores[node] = 1 + PathStepScore(targetSdf, sdfCells[y * gridWidth + x], 1, graph->wallFactor);
+            graph->nodeFrom[node] = targetNode;
+            SeedCluster(graph, node, x, y, startX, startY);
+        }
+    }
+
+    while (graph->nodeQueue.count > 0)
+    {
+        int node = PathHeap_pop(&graph->nodeQueue);
+        graph->expandedCount++;
+        if (node == startNode)
+        {
+            break;
+        }
+
+        int score = graph->nodeScores[node];
+        HierarchicalNode *abstractNode = &graph->nodes[node];
+        for (int i = 0; i < abstractNode->edgeCount; i++)
+        {
+            HierarchicalEdge edge = graph->edges[abstractNode->firstEdge + i];
+            RelaxNode(graph, edge.node, score + edge.cost, node, startX, startY);
+        }
+        if (abstractNode->cluster == startCluster && graph->startCosts[node - firstStartNode] >= 0)
+        {
+            RelaxNode(graph, startNode, score + graph->startCosts[node - firstStartNode], node, startX, startY);
+        }
+    }
+    PathHeap_clear(&graph->nodeQueue);
+
+    if (graph->nodeStamps[startNode] != graph->stamp)
+    {
+        return 0;
+    }
+
+    // the from pointers lead from the start to the target
+    for (int node = startNode; node >= 0; node = graph->nodeFrom[node])
+    {
+        int cell = node < graph->nodeCount ? graph->nodes[node].y * gridWidth + graph->nodes[node].x : graph->queryCells[node - graph->nodeCount];
+        graph->abstractPath[graph->abstractPathCount++] = cell;
+    }
+    return graph->abstractPathCount;
+}
+
+static void AppendPathCell(PathPoint *path, int *pathCount, int maxPathCount, int x, int y)
+{
+    if (*pathCount >= maxPathCount || (*pathCount > 0 && path[*pathCount - 1].x == x && path[*pathCount - 1].y == y))
+    {
+        return;
+    }
+    path[(*pathCount)++] = (PathPoint){ x, y };
+}
+
+int HierarchicalGraph_refinePath(HierarchicalGraph *graph, PathPoint *path, int maxPathCount)
+{
+    const PathGrid *grid = graph->grid;
+    int gridWidth = grid->width;
+    const unsigned short *sdfCells = grid->sdfCells;
+    int pathCount = 0;
+    graph->pathScore = 0;
+    // the abstract path only fits the SDF it was searched with
+    if (graph->abstractPathCount == 0 || maxPathCount == 0 || graph->sdfVersion != grid->sdfVersion)
+    {
+        return 0;
+    }
+
+    AppendPathCell(path, &pathCount, maxPathCount, graph->abstractPath[0] % gridWidth, graph->abstractPath[0] / gridWidth);
+    for (int i = 0; i + 1 < graph->abstractPathCount && pathCount < maxPathCount; i++)
+    {
+        int fromX = graph->abstractPath[i] % gridWidth;
+        int fromY = graph->abstractPath[i] / gridWidth;
+        int toX = graph->abstractPath[i + 1] % gridWidth;
+        int toY = graph->abstractPath[i + 1] / gridWidth;
+        int cluster = ClusterOf(graph, fromX, fromY);
+
+        // steps over a cluster border go to the neighbor cell
+        if (cluster != ClusterOf(graph, toX, toY))
+        {
+            AppendPathCell(path, &pathCount, maxPathCount, toX, toY);
+            continue;
+        }
+
+        // the search runs from the cell closer to the target, so the from pointers lead there
+        LocalSearch(graph, cluster, toX, toY, fromX, fromY);
+        int local = LocalIndex(graph, cluster, fromX, fromY);
+        if (graph->localScores[local] == 0)
+        {
+            // the cells of an abstract path are connected inside the cluster, a path through
+            // cells that aren't next to each other can't be scored or walked
+            graph->pathScore = 0;
+            return 0;
+        }
+        int x0 = cluster % graph->clustersX * graph->clusterSize;
+        int y0 = cluster / graph->clustersX * graph->clusterSize;
+        while (local >= 0 && graph->localScores[local] > 0)
+        {
+            AppendPathCell(path, &pathCount, maxPathCount, x0 + local % graph->clusterSize, y0 + local / graph->clusterSize);
+            local = graph->localFrom[local];
+        }
+        AppendPathCell(path, &pathCount, maxPathCount, toX, toY);
+    }
+
+    // the score Agent_findPath would give the start cell if it found this path
+    graph->pathScore = 1;
+    for (int i = pathCount - 2; i >= 0; i--)
+    {
+        PathPoint next = path[i + 1];
+        int dx = path[i].x - next.x;
+        int dy = path[i].y - next.y;
+        graph->pathScore += PathStepScore(sdfCells[next.y * gridWidth + next.x],
+            sdfCells[path[i].y * gridWidth + path[i].x], isqrt[dx * dx + dy * dy], graph->wallFactor);
+    }
+    return pathCount;
+}
+
+int HierarchicalGraph_findPath(HierarchicalGraph *graph, int startX, int startY, int targetX, int targetY, PathPoint *path, int maxPathCount)
+{
+    if (HierarchicalGraph_findAbstractPath(graph, startX, startY, targetX, targetY) == 0)
+    {
+        return 0;
+    }
+    return HierarchicalGraph_refinePath(graph, path, maxPathCount);
+}
+
+void Agent_findPathHierarchical(Agent *agent, HierarchicalGraph *graph)
+{
+    agent->pathCount = HierarchicalGraph_findPath(graph, agent->startX, agent->startY, agent->targetX, agent->targetY,
+        agent->path, agent->map.cellCount);
+    agent->pathScore = graph->pathScore;
+    agent->expandedCount = graph->expandedCount;
+}
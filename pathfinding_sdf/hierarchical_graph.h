@@ -0,0 +1,117 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - hierarchical pathfinding
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef HIERARCHICAL_GRAPH_H
+#define HIERARCHICAL_GRAPH_H
+
+#include "pathfinding.h"
+
+// long passable stretches of a cluster border get an entrance every this many cells
+#define HIERARCHICAL_ENTRANCE_SPACING 8
+
+// the start, the target and the 4 neighbors of the target are added to the abstract graph
+// during a query
+#define HIERARCHICAL_QUERY_NODES 6
+
+// an entrance cell of a cluster, its edges lead to the other entrances of the same cluster
+// and to the entrance on the other side of the border
+typedef struct HierarchicalNode
+{
+    int x, y;
+    int cluster;
+    int firstEdge;
+    int edgeCount;
+} HierarchicalNode;
+
+typedef struct HierarchicalEdge
+{
+    int node;
+    int cost;
+} HierarchicalEdge;
+
+// abstract graph over the grid (HPA*): the grid is split into square clusters, cells on
+// both sides of a cluster border where a unit fits through become nodes, and the costs
+// between the nodes of a cluster are searched in advance. A query only searches the
+// clusters of its start and target cell and the abstract graph in between; the graph is
+// built for one unit size and wall factor and is built again by the first query after the
+// SDF changed.
+typedef struct HierarchicalGraph
+{
+    PathGrid *grid;
+    int clusterSize;
+    int clustersX, clustersY;
+    int unitSize;
+    int wallFactor;
+    int enableJumping;
+    // sdfVersion of the grid the graph was built with
+    int sdfVersion;
+
+    HierarchicalNode *nodes;
+    int nodeCount;
+    HierarchicalEdge *edges;
+    int edgeCount;
+    // nodes are sorted by cluster, the nodes of cluster i are clusterFirstNode[i] until
+    // clusterFirstNode[i + 1]
+    int *clusterFirstNode;
+
+    // neighbor offsets sorted by distance, so the steps of a cell end at its max distance
+    NeighborOffset *offsets;
+
+    // state of the abstract search, a node is only valid if its stamp is the current one
+    int *nodeScores;
+    int *nodeFrom;
+    unsigned int *nodeStamps;
+    unsigned int stamp;
+    PathHeap nodeQueue;
+    int *startCosts;
+    // cells of the query nodes that follow the graph nodes
+    int queryCells[HIERARCHICAL_QUERY_NODES];
+
+    // state of the searches inside a single cluster
+    int *localScores;
+    int *localFrom;
+    PathHeap localQueue;
+
+    // cells of the last abstract path from the start to the target
+    int *abstractPath;
+    int abstractPathCount;
+    // number of abstract nodes taken from the open list during the last query
+    int expandedCount;
+    // score Agent_findPath would give the start of the last refined path
+    int pathScore;
+} HierarchicalGraph;
+
+HierarchicalGraph HierarchicalGraph_build(PathGrid *grid, int clusterSize, int unitSize, int wallFactor, int enableJumping);
+void HierarchicalGraph_free(HierarchicalGraph *graph);
+
+// builds the graph again if the SDF of the grid changed since it was built, the queries
+// call this before they search
+void HierarchicalGraph_update(HierarchicalGraph *graph);
+
+// searches the abstract graph and returns the number of cells of the abstract path, 0 if
+// the target can't be reached
+int HierarchicalGraph_findAbstractPath(HierarchicalGraph *graph, int startX, int startY, int targetX, int targetY);
+
+// searches the cell path along the last abstract path, limited to the clusters it crosses,
+// and returns the number of path nodes written. Stops after maxPathCount nodes, so a unit
+// can refine only the beginning of a long path. Returns 0 if the SDF changed since the
+// abstract path was searched
+int HierarchicalGraph_refinePath(HierarchicalGraph *graph, PathPoint *path, int maxPathCount);
+
+// both of the above
+int HierarchicalGraph_findPath(HierarchicalGraph *graph, int startX, int startY, int targetX, int targetY, PathPoint *path, int maxPathCount);
+
+// fills the path of the agent using the graph, which has to be built for the agent's unit
+// size and wall factor
+void Agent_findPathHierarchical(Agent *agent, HierarchicalGraph *graph);
+
+#endif
@@ -0,0 +1,321 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - incremental replanning
+*
+*   The search of Agent_findPath runs from the target to the start, so the scores in the map
+*   of an agent are the costs to reach the target from each cell. When walls are painted, most
+*   of these scores stay the same. The planner keeps the scores between frames and repairs
+*   them like lifelong planning A* (Koenig, Likhachev, Furcy 2004) without a heuristic:
+*   each cell has its score g and rhs, the lowest score its neighbors offer. Cells where
+*   both differ are queued and processed in the order of the lower of both values, until all
+*   cells are consistent again.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "incremental_planner.h"
+#include "clearance_labels.h"
+
+#include <stdlib.h> // Required for: malloc, free
+#include <limits.h> // Required for: INT_MAX
+
+#define PLANNER_INFINITE INT_MAX
+
+void Agent_enableIncrementalPlanner(Agent *agent)
+{
+    if (agent->planner != NULL)
+    {
+        return;
+    }
+    int cellCount = agent->grid->width * agent->grid->height;
+    IncrementalPlanner *planner = (IncrementalPlanner *)RL_CALLOC(1, sizeof(IncrementalPlanner));
+    planner->rhs = (int *)RL_MALLOC(cellCount * sizeof(int));
+    planner->queue = PathHeap_init(cellCount);
+    planner->valid = 0;
+    agent->planner = planner;
+}
+
+void IncrementalPlanner_free(Agent *agent)
+{
+    IncrementalPlanner *planner = agent->planner;
+    RL_FREE(planner->rhs);
+    PathHeap_free(&planner->queue);
+    RL_FREE(planner);
+    agent->planner = NULL;
+}
+
+void IncrementalPlanner_sync(Agent *agent, int enableJumping)
+{
+    IncrementalPlanner *planner = agent->planner;
+    // after a full search all cells are consistent, every reached cell got its score from
+    // the neighbor it points to
+    for (int i = 0; i < agent->map.cellCount; i++)
+    {
+        int score = PathMap_score(&agent->map, i);
+        planner->rhs[i] = score > 0 ? score : PLANNER_INFINITE;
+    }
+    while (planner->queue.count > 0)
+    {
+        PathHeap_pop(&planner->queue);
+    }
+    // a search rejected by the clearance labels didn't reach any cell, not even the target,
+    // and the next replan has to search in full
+    planner->valid = PathMap_score(&agent->map, agent->targetY * agent->grid->width + agent->targetX) > 0;
+    planner->enableJumping = enableJumping;
+    planner->targetX = agent->targetX;
+    planner->targetY = agent->targetY;
+    planner->unitSize = agent->unitSize;
+    planner->wallFactor = agent->wallFactor;
+}
+
+void IncrementalPlanner_invalidate(Agent *agent)
+{
+    agent->planner->valid = 0;
+}
+
+// the score of a cell, unreached cells have a score of 0 in the map
+static inline int PlannerScore(const Agent *agent, int cell)
+{
+    int score = PathMap_score(&agent->map, cell);
+    return score > 0 ? score : PLANNER_INFINITE;
+}
+
+static inline int StepAllowed(int stepDistance, int maxDistance, int enableJumping)
+{
+    return stepDistance <= maxDistance && (enableJumping || stepDistance <= 1);
+}
+
+static void SetParent(Agent *agent, int cell, int parent)
+{
+    PathMap_set(&agent->map, cell, parent < 0 ? PATH_NO_PARENT : (unsigned int)parent, PathMap_score(&agent->map, cell));
+}
+
+static void SetScore(Agent *agent, int cell, int score)
+{
+    PathMap_set(&agent->map, cell, PathMap_parent(&agent->map, cell), score);
+}
+
+// queues the cell if its score and rhs differ, using the lower of both as priority
+static void UpdateQueue(Agent *agent, int cell)
+{
+    IncrementalPlanner *planner = agent->planner;
+    int score = PlannerScore(agent, cell);
+    int rhs = planner->rhs[cell];
+    if (score != rhs)
+    {
+        PathHeap_push(&planner->queue, cell, score < rhs ? score : rhs);
+    }
+    else if (planner->queue.positions[cell] >= 0)
+    {
+        PathHeap_remove(&planner->queue, cell);
+    }
+}
+
+// recalculates rhs of a cell from all cells that can step onto it
+static void UpdateRhs(Agent *agent, int cell)
+{
+    const PathGrid *grid = agent->grid;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    const unsigned short *sdfCells = grid->sdfCells;
+    IncrementalPlanner *planner = agent->planner;
+    int x = cell % gridWidth;
+    int y = cell / gridWidth;
+    if (x == planner->targetX && y == planner->targetY)
+    {
+        // the search starts here, see Agent_findPath
+        return;
+    }
+
+    int best = PLANNER_INFINITE;
+    int bestParent = -1;
+    int cellSdf = sdfCells[cell];
+    if (cellSdf >= planner->unitSize)
+    {
+        for (int i = 0; i < neighborOffsetCount; i++)
+        {
+            int stepDistance = neighborOffsets[i].distance;
+            if (!planner->enableJumping && stepDistance > 1)
+            {
+                continue;
+            }
+            int px = x - neighborOffsets[i].x;
+            int py = y - neighborOffsets[i].y;
+            if (px < 0 || px >= gridWidth || py < 0 || py >= gridHeight)
+            {
+                continue;
+            }
+            int parent = py * gridWidth + px;
+            int parentScore = PlannerScore(agent, parent);
+            if (parentScore == PLANNER_INFINITE)
+            {
+                continue;
+            }
+            int parentSdf = sdfCells[parent];
+            if (!StepAllowed(stepDistance, PathMaxStepDistance(parentSdf, planner->unitSize), planner->enableJumping))
+            {
+                continue;
+            }
+            int score = parentScore + PathStepScore(parentSdf, cellSdf, stepDistance, planner->wallFactor);
+            if (score < best)
+            {
+                best = score;
+                bestParent = parent;
+            }
+        }
+    }
+
+    planner->rhs[cell] = best;
+    SetParent(agent, cell, bestParent);
+    UpdateQueue(agent, cell);
+}
+
+// a cell got a lower score: offer it to the cells it can step onto
+static void LowerSuccessors(Agent *agent, int cell)
+{
+    const PathGrid *grid = agent->grid;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    const unsigned short *sdfCells = grid->sdfCells;
+    IncrementalPlanner *planner = agent->planner;
+    int x = cell % gridWidth;
+    int y = cell / gridWidth;
+    int cellSdf = sdfCells[cell];
+    int cellScore = PlannerScore(agent, cell);
+    int maxDistance = PathMaxStepDistance(cellSdf, planner->unitSize);
+    for (int i = 0; i < neighborOffsetCount; i++)
+    {
+        int stepDistance = neighborOffsets[i].distance;
+        if (!StepAllowed(stepDistance, maxDistance, planner->enableJumping))
+        {
+            continue;
+        }
+        int nx = x + neighborOffsets[i].x;
+        int ny = y + neighborOffsets[i].y;
+        if (nx < 0 || nx >= gridWidth || ny < 0 || ny >= gridHeight || (nx == planner->targetX && ny == planner->targetY))
+        {
+            continue;
+        }
+        int next = ny * gridWidth + nx;
+        int nextSdf = sdfCells[next];
+        if (nextSdf < planner->unitSize)
+        {
+            continue;
+        }
+        int score = cellScore + PathStepScore(cellSdf, nextSdf, stepDistance, planner->wallFactor);
+        if (score < planner->rhs[next])
+        {
+            planner->rhs[next] = score;
+            SetParent(agent, next, cell);
+            UpdateQueue(agent, next);
+        }
+    }
+}
+
+// the score of a cell got worse or the steps from it changed: all cells that took their
+// score from this cell need to look for the best neighbor again
+static void RaiseSuccessors(Agent *agent, int cell)
+{
+    const PathGrid *grid = agent->grid;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    IncrementalPlanner *planner = agent->planner;
+    int x = cell % gridWidth;
+    int y = cell / gridWidth;
+    for (int i = 0; i < neighborOffsetCount; i++)
+    {
+        if (!planner->enableJumping && neighborOffsets[i].distance > 1)
+        {
+            continue;
+        }
+        int nx = x + neighborOffsets[i].x;
+        int ny = y + neighborOffsets[i].y;
+        if (nx < 0 || nx >= gridWidth || ny < 0 || ny >= gridHeight)
+        {
+            continue;
+        }
+        int next = ny * gridWidth + nx;
+        if (planner->rhs[next] != PLANNER_INFINITE && PathMap_parent(&agent->map, next) == (unsigned int)cell)
+        {
+            UpdateRhs(agent, next);
+        }
+    }
+}
+
+void Agent_replan(Agent *agent, int enableJumping, const int *changedCells, int changedCount)
+{
+    IncrementalPlanner *planner = agent->planner;
+    if (planner == NULL || !planner->valid || planner->enableJumping != enableJumping ||
+        planner->targetX != agent->targetX || planner->targetY != agent->targetY ||
+        planner->unitSize != agent->unitSize || planner->wallFactor != agent->wallFactor ||
+        !PathGrid_isReachable(agent->grid, agent->unitSize, agent->startX, agent->startY, agent->targetX, agent->targetY))
+    {
+        // a start the clearance labels rule out is rejected by the full search right away,
+        // repairing would raise every cell that lost its way to the target
+        Agent_findPath(agent, enableJumping);
+        return;
+    }
+
+    // the SDF value of a cell changes the steps onto it and the steps from it: the cell
+    // itself looks for its best neighbor again, and the cells it can step onto either get
+    // a better offer or have to look again if they took their score from it
+    for (int i = 0; i < changedCount; i++)
+    {
+        int cell = changedCells[i];
+        UpdateRhs(agent, cell);
+        RaiseSuccessors(agent, cell);
+        if (PlannerScore(agent, cell) != PLANNER_INFINITE)
+        {
+            LowerSuccessors(agent, cell);
+        }
+    }
+
+    int expandedCount = 0;
+    while (planner->queue.count > 0)
+    {
+        int cell = PathHeap_pop(&planner->queue);
+        expandedCount++;
+        int score = PlannerScore(agent, cell);
+        int rhs = planner->rhs[cell];
+        if (rhs < score)
+        {
+            // the cell got a better score, like a cell of the regular search
+            SetScore(agent, cell, rhs);
+            LowerSuccessors(agent, cell);
+        }
+        else
+        {
+            // the score got worse: the cell is reset to unreached until it is lowered
+            // again, and all cells depending on it are updated
+            SetScore(agent, cell, 0);
+            UpdateQueue(agent, cell);
+            RaiseSuccessors(agent, cell);
+        }
+    }
+    agent->expandedCount = expandedCount;
+
+    Agent_extractPath(agent);
+}
@@ -0,0 +1,49 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - incremental replanning
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef INCREMENTAL_PLANNER_H
+#define INCREMENTAL_PLANNER_H
+
+#include "pathfinding.h"
+
+// state of the lifelong planning A* (LPA*) search of an agent: the score of each cell in
+// the agent's map is its g value, rhs is the best score its neighbors offer
+typedef struct IncrementalPlanner
+{
+    int *rhs;
+    // cells whose score and rhs value differ
+    PathHeap queue;
+    // parameters of the search the state belongs to, changing any of these requires
+    // a full search
+    int valid;
+    int enableJumping;
+    int targetX, targetY;
+    int unitSize;
+    int wallFactor;
+} IncrementalPlanner;
+
+// keeps the search state of the agent between searches, so Agent_replan can repair it
+void Agent_enableIncrementalPlanner(Agent *agent);
+
+// updates the path of the agent after the SDF values of the given cells changed. Only
+// the part of the map whose scores depend on these cells is searched again, changes of the
+// target or the agent parameters fall back to a full search.
+void Agent_replan(Agent *agent, int enableJumping, const int *changedCells, int changedCount);
+
+// called by Agent_findPath to take over the result of a full search
+void IncrementalPlanner_sync(Agent *agent, int enableJumping);
+// called by the searches that write the agent's map without finding every cell's best score,
+// the next Agent_replan searches in full
+void IncrementalPlanner_invalidate(Agent *agent);
+void IncrementalPlanner_free(Agent *agent);
+
+#endif
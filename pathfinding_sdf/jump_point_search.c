@@ -0,0 +1,250 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - jump point search
+*
+*   Without jumping and without a wall factor, the search moves along the axes and every
+*   step costs the same. In open areas there are many paths of the same cost between two
+*   cells and the search queues all cells on all of them. Jump point search only follows
+*   one of these paths: a path runs vertically and may turn horizontally anywhere, but it
+*   only turns from horizontal to vertical where a blocked cell prevented turning earlier.
+*   The search scans along rows and columns without queuing cells and only queues the cells
+*   where such a turn can happen.
+*
+*   A cell is blocked for a unit if its SDF value is smaller than the unit size, like in
+*   Agent_findPath. The SDF value also tells how far a scan can skip ahead: no cell closer
+*   to the current cell than its SDF value minus the unit size can be blocked.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "jump_point_search.h"
+#include "clearance_labels.h"
+#include "incremental_planner.h"
+
+#include <stdlib.h> // Required for: abs
+
+// the cell where the scans end, the search runs from the target to the start
+typedef struct JumpPointGoal
+{
+    const PathGrid *grid;
+    int x, y;
+    int unitSize;
+} JumpPointGoal;
+
+static int IsPassable(const JumpPointGoal *goal, int x, int y)
+{
+    const PathGrid *grid = goal->grid;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    const unsigned short *sdfCells = grid->sdfCells;
+    return x >= 0 && x < gridWidth && y >= 0 && y < gridHeight && sdfCells[y * gridWidth + x] >= goal->unitSize;
+}
+
+// scans along the row from x in direction dx, returns the x of the first jump point or -1
+static int JumpHorizontal(const JumpPointGoal *goal, int x, int y, int dx)
+{
+    const PathGrid *grid = goal->grid;
+    int gridWidth = grid->width;
+    const unsigned short *sdfCells = grid->sdfCells;
+    while (1)
+    {
+        x += dx;
+        if (!IsPassable(goal, x, y))
+        {
+            return -1;
+        }
+        if (x == goal->x && y == goal->y)
+        {
+            return x;
+        }
+
+        // a vertical turn is only needed here if the cell behind it is blocked
+        if ((IsPassable(goal, x, y - 1) && !IsPassable(goal, x - dx, y - 1)) ||
+            (IsPassable(goal, x, y + 1) && !IsPassable(goal, x - dx, y + 1)))
+        {
+            return x;
+        }
+
+        // the SDF value is rounded up, so the cells next to the skipped cells are only
+        // known to be free if they are 2 cells closer than the SDF value allows
+        int skip = sdfCells[y * gridWidth + x] - goal->unitSize - 2;
+        if (skip > 0)
+        {
+            int edgeDistance = dx > 0 ? gridWidth - 1 - x : x;
+            skip = skip < edgeDistance ? skip : edgeDistance;
+            int goalDistance = (goal->x - x) * dx;
+            if (y == goal->y && goalDistance > 0 && goalDistance <= skip)
+            {
+                skip = goalDistance - 1;
+            }
+            x += dx * skip;
+        }
+    }
+}
+
+// scans along the column from y in direction dy, returns the y of the first cell that is
+// a jump point or has one in its row, -1 if there is none
+static int JumpVertical(const JumpPointGoal *goal, int x, int y, int dy)
+{
+    while (1)
+    {
+        y += dy;
+        if (!IsPassable(goal, x, y))
+        {
+            return -1;
+        }
+        if ((x == goal->x && y == goal->y) || JumpHorizontal(goal, x, y, -1) >= 0 || JumpHorizontal(goal, x, y, 1) >= 0)
+        {
+            return y;
+        }
+    }
+}
+
+static void QueueJumpPoint(Agent *agent, PathHeap *queue, int from, int x, int y)
+{
+    const PathGrid *grid = agent->grid;
+    int gridWidth = grid->width;
+    int cell = y * gridWidth + x;
+    int score = agent->map.scores[from] + abs(x - from % gridWidth) + abs(y - from / gridWidth);
+    int previousScore = PathMap_score(&agent->map, cell);
+    if (previousScore != 0 && previousScore <= score)
+    {
+        return;
+    }
+    PathMap_set(&agent->map, cell, from, score);
+
+    // the distance to the start is the lowest cost a path from here can have
+    PathHeap_push(queue, cell, score + abs(x - agent->startX) + abs(y - agent->startY));
+}
+
+void Agent_findPathJumpPoints(Agent *agent)
+{
+    const PathGrid *grid = agent->grid;
+    int gridWidth = grid->width;
+    // Agent_findPath also rejects searches for starts the clearance labels rule out
+    if (agent->wallFactor != 0 || !PathGrid_isReachable(grid, agent->unitSize, agent->startX, agent->startY, agent->targetX, agent->targetY))
+    {
+        Agent_findPath(agent, 0);
+        return;
+    }
+
+    PathMap *map = &agent->map;
+    PathMap_reset(map);
+    if (agent->planner != NULL)
+    {
+        // the map of this search can't be repaired, a fallback to Agent_findPath syncs again
+        IncrementalPlanner_invalidate(agent);
+    }
+
+    // like in Agent_findPath, the search runs from the target to the start
+    JumpPointGoal goal = { agent->grid, agent->startX, agent->startY, agent->unitSize };
+    int goalCell = goal.y * gridWidth + goal.x;
+    PathHeap *queue = &PathSearchArena_get(gridWidth * grid->height)->queue;
+    PathMap_set(map, agent->targetY * gridWidth + agent->targetX, PATH_NO_PARENT, 1);
+    PathHeap_push(queue, agent->targetY * gridWidth + agent->targetX, 1);
+
+    int expandedCount = 0;
+    while (queue->count > 0)
+    {
+        int cell = PathHeap_pop(queue);
+        expandedCount++;
+        if (cell == goalCell)
+        {
+            break;
+        }
+
+        int x = cell % gridWidth;
+        int y = cell / gridWidth;
+        // jumps only go along rows and columns, the direction is the one of the last jump
+        unsigned int parent = map->parents[cell];
+        int parentX = parent == PATH_NO_PARENT ? x : (int)(parent % gridWidth);
+        int parentY = parent == PATH_NO_PARENT ? y : (int)(parent / gridWidth);
+        int dx = (x > parentX) - (x < parentX);
+        int dy = (y > parentY) - (y < parentY);
+
+        // rows can be entered from anywhere, but only from a column
+        if (dx == 0)
+        {
+            for (int direction = -1; direction <= 1; direction += 2)
+            {
+                int jumpX = JumpHorizontal(&goal, x, y, direction);
+                if (jumpX >= 0)
+                {
+                    QueueJumpPoint(agent, queue, cell, jumpX, y);
+                }
+            }
+        }
+        else
+        {
+            int jumpX = JumpHorizontal(&goal, x, y, dx);
+            if (jumpX >= 0)
+            {
+                QueueJumpPoint(agent, queue, cell, jumpX, y);
+            }
+        }
+
+        // columns continue, and are entered from a row where the cell behind is blocked
+        for (int direction = -1; direction <= 1; direction += 2)
+        {
+            int turnsHere = dx != 0 && IsPassable(&goal, x, y + direction) && !IsPassable(&goal, x - dx, y + direction);
+            if (dy == direction || (dx == 0 && dy == 0) || turnsHere)
+            {
+                int jumpY = JumpVertical(&goal, x, y, direction);
+                if (jumpY >= 0)
+                {
+                    QueueJumpPoint(agent, queue, cell, x, jumpY);
+                }
+            }
+        }
+    }
+    agent->expandedCount = expandedCount;
+    PathHeap_clear(queue);
+
+    // the path is filled with every cell between the jump points
+    agent->pathCount = 0;
+    agent->pathScore = PathMap_score(map, goalCell);
+    if (agent->pathScore == 0)
+    {
+        return;
+    }
+    int x = goal.x;
+    int y = goal.y;
+    while (x != agent->targetX || y != agent->targetY)
+    {
+        unsigned int parent = map->parents[y * gridWidth + x];
+        int parentX = parent % gridWidth;
+        int parentY = parent / gridWidth;
+        int stepX = (parentX > x) - (parentX < x);
+        int stepY = (parentY > y) - (parentY < y);
+        while (x != parentX || y != parentY)
+        {
+            agent->path[agent->pathCount++] = (PathPoint){ x, y };
+            x += stepX;
+            y += stepY;
+        }
+    }
+    agent->path[agent->pathCount++] = (PathPoint){ x, y };
+}
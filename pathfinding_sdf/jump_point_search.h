@@ -0,0 +1,24 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - jump point search
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef JUMP_POINT_SEARCH_H
+#define JUMP_POINT_SEARCH_H
+
+#include "pathfinding.h"
+
+// searches the same path cost as Agent_findPath without jumping, but only queues the
+// cells where a path may have to turn (jump points) instead of every cell. This only works
+// if every step costs the same, so agents with a wall factor use Agent_findPath instead.
+// The map only contains the jump points, the path contains every cell.
+void Agent_findPathJumpPoints(Agent *agent);
+
+#endif
@@ -0,0 +1,217 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - batched pathfinding
+*
+*   The worker threads are started once and wait for batches. The agents of a batch are
+*   handed out one at a time, so threads that finish short searches early pick up more
+*   agents instead of waiting for the others.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "path_batch.h"
+
+#include <stdlib.h> // Required for: malloc, free
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #include <windows.h>
+    typedef HANDLE WorkerThread;
+    typedef CRITICAL_SECTION WorkerMutex;
+    typedef CONDITION_VARIABLE WorkerCondition;
+    #define WorkerMutex_init(m) InitializeCriticalSection(m)
+    #define WorkerMutex_destroy(m) DeleteCriticalSection(m)
+    #define WorkerMutex_lock(m) EnterCriticalSection(m)
+    #define WorkerMutex_unlock(m) LeaveCriticalSection(m)
+    #define WorkerCondition_init(c) InitializeConditionVariable(c)
+    #define WorkerCondition_destroy(c)
+    #define WorkerCondition_wait(c, m) SleepConditionVariableCS(c, m, INFINITE)
+    #define WorkerCondition_broadcast(c) WakeAllConditionVariable(c)
+#else
+    #include <pthread.h>
+    typedef pthread_t WorkerThread;
+    typedef pthread_mutex_t WorkerMutex;
+    typedef pthread_cond_t WorkerCondition;
+    #define WorkerMutex_init(m) pthread_mutex_init(m, NULL)
+    #define WorkerMutex_destroy(m) pthread_mutex_destroy(m)
+    #define WorkerMutex_lock(m) pthread_mutex_lock(m)
+    #define WorkerMutex_unlock(m) pthread_mutex_unlock(m)
+    #define WorkerCondition_init(c) pthread_cond_init(c, NULL)
+    #define WorkerCondition_destroy(c) pthread_cond_destroy(c)
+    #define WorkerCondition_wait(c, m) pthread_cond_wait(c, m)
+    #define WorkerCondition_broadcast(c) pthread_cond_broadcast(c)
+#endif
+
+struct PathWorkerPool
+{
+    WorkerThread *threads;
+    int workerCount;
+    WorkerMutex mutex;
+    // signaled when a new batch starts or the pool shuts down
+    WorkerCondition batchStarted;
+    // signaled when the last agent of a batch is done
+    WorkerCondition batchDone;
+    int batchId;
+    int shutdown;
+
+    // the running batch
+    Agent **agents;
+    int agentCount;
+    int enableJumping;
+    int nextAgent;
+    int pendingCount;
+};
+
+// searches agents of the current batch until none are left, called with the mutex locked
+static void RunBatchAgents(PathWorkerPool *pool)
+{
+    while (pool->nextAgent < pool->agentCount)
+    {
+        Agent *agent = pool->agents[pool->nextAgent++];
+        int enableJumping = pool->enableJumping;
+        WorkerMutex_unlock(&pool->mutex);
+
+        Agent_findPath(agent, enableJumping);
+
+        WorkerMutex_lock(&pool->mutex);
+        pool->pendingCount--;
+        if (pool->pendingCount == 0)
+        {
+            WorkerCondition_broadcast(&pool->batchDone);
+        }
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI WorkerMain(LPVOID data)
+#else
+static void *WorkerMain(void *data)
+#endif
+{
+    PathWorkerPool *pool = (PathWorkerPool *)data;
+    int lastBatchId = 0;
+    WorkerMutex_lock(&pool->mutex);
+    while (1)
+    {
+        while (!pool->shutdown && pool->batchId == lastBatchId)
+        {
+            WorkerCondition_wait(&pool->batchStarted, &pool->mutex);
+        }
+        if (pool->shutdown)
+        {
+            break;
+        }
+        lastBatchId = pool->batchId;
+        RunBatchAgents(pool);
+    }
+    WorkerMutex_unlock(&pool->mutex);
+    PathSearchArena_releaseThread();
+    return 0;
+}
+
+static int StartWorkerThread(PathWorkerPool *pool, WorkerThread *thread)
+{
+#if defined(_WIN32)
+    *thread = CreateThread(NULL, 0, WorkerMain, pool, 0, NULL);
+    return *thread != NULL;
+#else
+    return pthread_create(thread, NULL, WorkerMain, pool) == 0;
+#endif
+}
+
+PathWorkerPool *PathWorkerPool_create(int threadCount)
+{
+    PathWorkerPool *pool = (PathWorkerPool *)RL_CALLOC(1, sizeof(PathWorkerPool));
+    WorkerMutex_init(&pool->mutex);
+    WorkerCondition_init(&pool->batchStarted);
+    WorkerCondition_init(&pool->batchDone);
+
+    // the calling thread searches too, so one thread less is started. A thread that fails to
+    // start is not retried, the pool works with the ones it has and only those are joined.
+    int workerCount = threadCount > 1 ? threadCount - 1 : 0;
+    pool->threads = (WorkerThread *)RL_MALLOC(workerCount * sizeof(WorkerThread));
+    while (pool->workerCount < workerCount && StartWorkerThread(pool, &pool->threads[pool->workerCount]))
+    {
+        pool->workerCount++;
+    }
+    return pool;
+}
+
+void PathWorkerPool_destroy(PathWorkerPool *pool)
+{
+    WorkerMutex_lock(&pool->mutex);
+    pool->shutdown = 1;
+    WorkerCondition_broadcast(&pool->batchStarted);
+    WorkerMutex_unlock(&pool->mutex);
+    for (int i = 0; i < pool->workerCount; i++)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+    WorkerCondition_destroy(&pool->batchStarted);
+    WorkerCondition_destroy(&pool->batchDone);
+    WorkerMutex_destroy(&pool->mutex);
+    RL_FREE(pool->threads);
+    RL_FREE(pool);
+}
+
+int PathWorkerPool_threadCount(const PathWorkerPool *pool)
+{
+    return pool->workerCount + 1;
+}
+
+void Agent_findPathBatch(PathWorkerPool *pool, Agent **agents, int agentCount, int enableJumping)
+{
+    if (agentCount <= 0)
+    {
+        return;
+    }
+
+    WorkerMutex_lock(&pool->mutex);
+    pool->agents = agents;
+    pool->agentCount = agentCount;
+    pool->enableJumping = enableJumping;
+    pool->nextAgent = 0;
+    pool->pendingCount = agentCount;
+    pool->batchId++;
+    WorkerCondition_broadcast(&pool->batchStarted);
+
+    // the calling thread helps out instead of just waiting
+    RunBatchAgents(pool);
+    while (pool->pendingCount > 0)
+    {
+        WorkerCondition_wait(&pool->batchDone, &pool->mutex);
+    }
+    pool->agents = NULL;
+    pool->agentCount = 0;
+    WorkerMutex_unlock(&pool->mutex);
+}
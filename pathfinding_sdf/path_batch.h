@@ -0,0 +1,32 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - batched pathfinding
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef PATH_BATCH_H
+#define PATH_BATCH_H
+
+#include "pathfinding.h"
+
+typedef struct PathWorkerPool PathWorkerPool;
+
+// creates a pool that runs batches on threadCount threads, the thread calling
+// Agent_findPathBatch is one of them, so a thread count of 1 runs everything on the caller
+PathWorkerPool *PathWorkerPool_create(int threadCount);
+void PathWorkerPool_destroy(PathWorkerPool *pool);
+int PathWorkerPool_threadCount(const PathWorkerPool *pool);
+
+// runs Agent_findPath for all agents in parallel and returns when all are done. Each agent
+// searches with its own map, path and open list, the grids are only read, so the results
+// are the same for any number of threads. The agents may belong to different grids, none
+// of them must be changed while the batch runs.
+void Agent_findPathBatch(PathWorkerPool *pool, Agent **agents, int agentCount, int enableJumping);
+
+#endif
@@ -0,0 +1,265 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - time sliced path requests
+*
+*   Searching a whole map can take longer than a frame. The queue runs the searches of the
+*   agents a slice at a time and stops when the time budget of the frame is used up, the
+*   next frame continues where it stopped. Each request searches into a map of its own and
+*   the agent keeps using its previous map and path; when the search is done, the maps are
+*   swapped and the new path is extracted, so the agent never sees a half searched map.
+*   The maps and open lists of the requests are kept for the next request of the agent.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "path_request.h"
+#include "incremental_planner.h"
+
+#include <stdlib.h> // Required for: malloc, free, NULL
+#include <time.h> // Required for: timespec_get
+
+typedef struct PathRequest
+{
+    // NULL if the slot is free
+    Agent *agent;
+    unsigned int id;
+    PathRequestStatus status;
+    int enableJumping;
+    // requests run in ascending order, a replaced request keeps the order of the old one
+    unsigned int order;
+    // set while the search has nodes in its open list
+    int started;
+    // sdfVersion of the grid the search started with
+    int sdfVersion;
+    PathSearch search;
+    PathMap map;
+    PathHeap queue;
+    int cellCount;
+} PathRequest;
+
+struct PathRequestQueue
+{
+    // the requests are allocated one by one, their searches point to their maps and queues
+    PathRequest **requests;
+    int requestCount;
+    unsigned int nextId;
+    unsigned int nextOrder;
+};
+
+static long long GetMicroseconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+PathRequestQueue *PathRequestQueue_create(void)
+{
+    PathRequestQueue *queue = (PathRequestQueue *)RL_CALLOC(1, sizeof(PathRequestQueue));
+    queue->nextId = 1;
+    return queue;
+}
+
+void PathRequestQueue_destroy(PathRequestQueue *queue)
+{
+    for (int i = 0; i < queue->requestCount; i++)
+    {
+        PathRequest *request = queue->requests[i];
+        if (request->cellCount > 0)
+        {
+            PathMap_free(&request->map);
+            PathHeap_free(&request->queue);
+        }
+        RL_FREE(request);
+    }
+    RL_FREE(queue->requests);
+    RL_FREE(queue);
+}
+
+// the slot of the agent, a free slot or a new one
+static int PathRequestQueue_getSlot(PathRequestQueue *queue, const Agent *agent)
+{
+    int freeSlot = -1;
+    for (int i = 0; i < queue->requestCount; i++)
+    {
+        if (queue->requests[i]->agent == agent)
+        {
+            return i;
+        }
+        if (queue->requests[i]->agent == NULL && freeSlot < 0)
+        {
+            freeSlot = i;
+        }
+    }
+    if (freeSlot >= 0)
+    {
+        return freeSlot;
+    }
+    queue->requests = (PathRequest **)RL_REALLOC(queue->requests, (queue->requestCount + 1) * sizeof(PathRequest *));
+    queue->requests[queue->requestCount] = (PathRequest *)RL_CALLOC(1, sizeof(PathRequest));
+    return queue->requestCount++;
+}
+
+// stops the search of the request, its open list is empty afterwards
+static void PathRequest_stop(PathRequest *request)
+{
+    if (request->started)
+    {
+        PathHeap_clear(&request->queue);
+    }
+    request->started = 0;
+}
+
+PathRequestHandle PathRequestQueue_request(PathRequestQueue *queue, Agent *agent, int enableJumping)
+{
+    int slot = PathRequestQueue_getSlot(queue, agent);
+    PathRequest *request = queue->requests[slot];
+    PathRequest_stop(request);
+    if (request->agent != agent || request->status != PATH_REQUEST_PENDING)
+    {
+        request->order = queue->nextOrder++;
+    }
+
+    // the map is swapped with the one of the agent when the path lands, so both have its size
+    int cellCount = agent->map.cellCount;
+    if (request->cellCount != cellCount)
+    {
+        if (request->cellCount > 0)
+        {
+            PathMap_free(&request->map);
+            PathHeap_free(&request->queue);
+        }
+        request->map = PathMap_init(cellCount);
+        request->queue = PathHeap_init(cellCount);
+        request->cellCount = cellCount;
+    }
+
+    request->agent = agent;
+    request->id = queue->nextId++;
+    request->status = PATH_REQUEST_PENDING;
+    request->enableJumping = enableJumping;
+    return (PathRequestHandle){ slot, request->id };
+}
+
+PathRequestStatus PathRequestQueue_status(const PathRequestQueue *queue, PathRequestHandle handle)
+{
+    if (handle.slot < 0 || handle.slot >= queue->requestCount || queue->requests[handle.slot]->id != handle.id)
+    {
+        return PATH_REQUEST_CANCELED;
+    }
+    return queue->requests[handle.slot]->status;
+}
+
+void PathRequestQueue_cancel(PathRequestQueue *queue, const Agent *agent)
+{
+    for (int i = 0; i < queue->requestCount; i++)
+    {
+        PathRequest *request = queue->requests[i];
+        if (request->agent == agent)
+        {
+            PathRequest_stop(request);
+            request->agent = NULL;
+            request->id = 0;
+            request->status = PATH_REQUEST_CANCELED;
+        }
+    }
+}
+
+int PathRequestQueue_pendingCount(const PathRequestQueue *queue)
+{
+    int count = 0;
+    for (int i = 0; i < queue->requestCount; i++)
+    {
+        count += queue->requests[i]->status == PATH_REQUEST_PENDING;
+    }
+    return count;
+}
+
+// the pending request that was requested first
+static PathRequest *PathRequestQueue_next(PathRequestQueue *queue)
+{
+    PathRequest *next = NULL;
+    for (int i = 0; i < queue->requestCount; i++)
+    {
+        PathRequest *request = queue->requests[i];
+        if (request->status == PATH_REQUEST_PENDING && (next == NULL || (int)(request->order - next->order) < 0))
+        {
+            next = request;
+        }
+    }
+    return next;
+}
+
+// hands the searched map to the agent and takes its old map for the next search
+static void PathRequest_land(PathRequest *request)
+{
+    Agent *agent = request->agent;
+    PathMap map = agent->map;
+    agent->map = request->map;
+    request->map = map;
+    request->started = 0;
+    request->status = PATH_REQUEST_DONE;
+
+    agent->expandedCount = request->search.expandedCount;
+    Agent_extractPath(agent);
+    if (agent->planner != NULL)
+    {
+        IncrementalPlanner_sync(agent, request->enableJumping);
+    }
+}
+
+int PathRequestQueue_update(PathRequestQueue *queue, int budgetMicroseconds)
+{
+    long long startTime = GetMicroseconds();
+    int landedCount = 0;
+    PathRequest *request;
+    while ((request = PathRequestQueue_next(queue)) != NULL)
+    {
+        // a search that started before the SDF changed would mix old and new values
+        const PathGrid *grid = request->agent->grid;
+        if (request->started && request->sdfVersion != grid->sdfVersion)
+        {
+            PathRequest_stop(request);
+        }
+        if (!request->started)
+        {
+            request->search = PathSearch_begin(request->agent, &request->map, &request->queue, request->enableJumping);
+            request->sdfVersion = grid->sdfVersion;
+            request->started = 1;
+        }
+
+        if (PathSearch_run(&request->search, PATH_REQUEST_SLICE_EXPANSIONS))
+        {
+            PathRequest_land(request);
+            landedCount++;
+        }
+        if (GetMicroseconds() - startTime >= budgetMicroseconds)
+        {
+            break;
+        }
+    }
+    return landedCount;
+}
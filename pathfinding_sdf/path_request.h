@@ -0,0 +1,59 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - time sliced path requests
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef PATH_REQUEST_H
+#define PATH_REQUEST_H
+
+#include "pathfinding.h"
+
+// nodes a search expands between two checks of the time budget
+#define PATH_REQUEST_SLICE_EXPANSIONS 256
+
+typedef struct PathRequestQueue PathRequestQueue;
+
+typedef enum PathRequestStatus
+{
+    // the request was replaced by a newer one of the same agent or canceled
+    PATH_REQUEST_CANCELED,
+    // the search is queued or running, the agent still has its previous path
+    PATH_REQUEST_PENDING,
+    // the path has landed in the agent
+    PATH_REQUEST_DONE,
+} PathRequestStatus;
+
+typedef struct PathRequestHandle
+{
+    int slot;
+    unsigned int id;
+} PathRequestHandle;
+
+PathRequestQueue *PathRequestQueue_create(void);
+void PathRequestQueue_destroy(PathRequestQueue *queue);
+
+// queues an Agent_findPath search for the agent. The agent keeps its map and path until the
+// search is done, then both are replaced at once. A request of an agent that already has a
+// pending one replaces it and keeps its place in the queue. The start, target, unit size and
+// wall factor of the agent are read when the search starts, request again after changing them.
+PathRequestHandle PathRequestQueue_request(PathRequestQueue *queue, Agent *agent, int enableJumping);
+PathRequestStatus PathRequestQueue_status(const PathRequestQueue *queue, PathRequestHandle handle);
+// drops the pending request of the agent, agents must be canceled before they are freed
+void PathRequestQueue_cancel(PathRequestQueue *queue, const Agent *agent);
+
+// runs the pending searches in the order they were requested until the budget is used up
+// and returns the number of paths that landed. A search is paused between slices of
+// PATH_REQUEST_SLICE_EXPANSIONS expanded nodes and resumed by the next update; it starts
+// over if the SDF of its grid changed in between. At least one slice runs per update, so
+// every search finishes with any budget.
+int PathRequestQueue_update(PathRequestQueue *queue, int budgetMicroseconds);
+int PathRequestQueue_pendingCount(const PathRequestQueue *queue);
+
+#endif
@@ -0,0 +1,204 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - path smoothing
+*
+*   The searches move from cell to cell, or jump in the directions of the neighbor offsets,
+*   so paths through open areas zigzag and have many more nodes than needed. A node can be
+*   removed if the unit can walk straight from the node before it to the node after it.
+*   Whether it can is checked by marching along the line through the SDF, which works like
+*   the jumps of the search: a cell with a large SDF value guarantees that all cells around
+*   it are free, so the march can skip ahead; only close to walls every cell is checked.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "path_smoothing.h"
+
+#include <stdlib.h> // Required for: abs
+#include <math.h> // Required for: sqrtf, floorf
+
+static int IsPassable(const PathGrid *grid, int x, int y, int unitSize)
+{
+    return PathGrid_contains(grid, x, y) && grid->sdfCells[y * grid->width + x] >= unitSize;
+}
+
+int IsLineWalkable(const PathGrid *grid, int fromX, int fromY, int toX, int toY, int unitSize)
+{
+    int countX = abs(toX - fromX);
+    int countY = abs(toY - fromY);
+    int stepX = toX > fromX ? 1 : -1;
+    int stepY = toY > fromY ? 1 : -1;
+    float length = sqrtf((float)(countX * countX + countY * countY));
+
+    // number of cells the march has moved along each axis
+    int movedX = 0;
+    int movedY = 0;
+    while (1)
+    {
+        int x = fromX + movedX * stepX;
+        int y = fromY + movedY * stepY;
+        if (!IsPassable(grid, x, y, unitSize))
+        {
+            return 0;
+        }
+        if (movedX == countX && movedY == countY)
+        {
+            return 1;
+        }
+
+        // the SDF value is rounded up and the line passes up to half a diagonal away from
+        // the cell centers, and for the manhattan SDF a cell at a distance of d can be up to
+        // d * sqrt(2) steps away. Halving the SDF value and leaving a margin of 2 cells
+        // covers all of it, so every cell the skipped part of the line touches is free.
+        int skip = (grid->sdfCells[y * grid->width + x] - unitSize) / 2 - 2;
+        if (skip > 0)
+        {
+            // fraction of the line where it enters the current cell
+            float enterX = movedX > 0 ? (movedX - 0.5f) / countX : 0.0f;
+            float enterY = movedY > 0 ? (movedY - 0.5f) / countY : 0.0f;
+            float fraction = (enterX > enterY ? enterX : enterY) + skip / length;
+            if (fraction >= 1.0f)
+            {
+                return 1;
+            }
+            int skippedX = (int)(countX * fraction + 0.5f);
+            int skippedY = (int)(countY * fraction + 0.5f);
+            // short skips can round to the current cell, then the march steps as usual
+            if (skippedX > movedX || skippedY > movedY)
+            {
+                movedX = skippedX > movedX ? skippedX : movedX;
+                movedY = skippedY > movedY ? skippedY : movedY;
+                continue;
+            }
+        }
+
+        // otherwise step to the neighbor cell on the side where the line leaves the cell.
+        // The line crosses the next column border at (2 * movedX + 1) / (2 * countX) and the
+        // next row border at (2 * movedY + 1) / (2 * countY), compared without dividing.
+        int side = (2 * movedX + 1) * countY - (2 * movedY + 1) * countX;
+        if (side < 0)
+        {
+            movedX++;
+        }
+        else if (side > 0)
+        {
+            movedY++;
+        }
+        else
+        {
+            // the line passes through a corner, the unit touches both cells next to it
+            if (!IsPassable(grid, x + stepX, y, unitSize) || !IsPassable(grid, x, y + stepY, unitSize))
+            {
+                return 0;
+            }
+            movedX++;
+            movedY++;
+        }
+    }
+}
+
+int SmoothPath(const PathGrid *grid, PathPoint *path, int pathCount, int unitSize)
+{
+    if (pathCount <= 2)
+    {
+        return pathCount;
+    }
+
+    // each kept node is the last one that can still be reached in a straight line from
+    // the node kept before it. Nodes are only written to indices that were already read.
+    PathPoint anchor = path[0];
+    int count = 1;
+    for (int i = 2; i < pathCount; i++)
+    {
+        if (!IsLineWalkable(grid, anchor.x, anchor.y, path[i].x, path[i].y, unitSize))
+        {
+            anchor = path[i - 1];
+            path[count++] = anchor;
+        }
+    }
+    path[count++] = path[pathCount - 1];
+    return count;
+}
+
+void Agent_smoothPath(Agent *agent)
+{
+    agent->pathCount = SmoothPath(agent->grid, agent->path, agent->pathCount, agent->unitSize);
+}
+
+static Vector2 PathPointCenter(PathPoint point)
+{
+    return (Vector2){ point.x + 0.5f, point.y + 0.5f };
+}
+
+int SamplePathSpline(const PathGrid *grid, const PathPoint *path, int pathCount, int unitSize, int samplesPerSegment, Vector2 *points, int maxPointCount)
+{
+    if (pathCount == 0 || maxPointCount == 0)
+    {
+        return 0;
+    }
+
+    int count = 0;
+    points[count++] = PathPointCenter(path[0]);
+    for (int i = 0; i + 1 < pathCount; i++)
+    {
+        // the first and last node are repeated as the outer control points
+        Vector2 p0 = PathPointCenter(path[i > 0 ? i - 1 : 0]);
+        Vector2 p1 = PathPointCenter(path[i]);
+        Vector2 p2 = PathPointCenter(path[i + 1]);
+        Vector2 p3 = PathPointCenter(path[i + 2 < pathCount ? i + 2 : pathCount - 1]);
+
+        int segmentStart = count;
+        int curved = 1;
+        for (int s = 1; s <= samplesPerSegment && count < maxPointCount; s++)
+        {
+            float t = (float)s / samplesPerSegment;
+            float t2 = t * t;
+            float t3 = t2 * t;
+            Vector2 point = {
+                0.5f * (2.0f * p1.x + (p2.x - p0.x) * t + (2.0f * p0.x - 5.0f * p1.x + 4.0f * p2.x - p3.x) * t2 + (3.0f * p1.x - p0.x - 3.0f * p2.x + p3.x) * t3),
+                0.5f * (2.0f * p1.y + (p2.y - p0.y) * t + (2.0f * p0.y - 5.0f * p1.y + 4.0f * p2.y - p3.y) * t2 + (3.0f * p1.y - p0.y - 3.0f * p2.y + p3.y) * t3),
+            };
+            // the curve bulges out of the straight segment, which was checked to be walkable
+            if (!IsPassable(grid, (int)floorf(point.x), (int)floorf(point.y), unitSize))
+            {
+                curved = 0;
+                break;
+            }
+            points[count++] = point;
+        }
+
+        if (!curved)
+        {
+            count = segmentStart;
+            for (int s = 1; s <= samplesPerSegment && count < maxPointCount; s++)
+            {
+                float t = (float)s / samplesPerSegment;
+                points[count++] = (Vector2){ p1.x + (p2.x - p1.x) * t, p1.y + (p2.y - p1.y) * t };
+            }
+        }
+    }
+    return count;
+}
@@ -0,0 +1,37 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - path smoothing
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef PATH_SMOOTHING_H
+#define PATH_SMOOTHING_H
+
+#include "pathfinding.h"
+
+// true if a unit of the given size can move in a straight line from the center of one cell
+// to the center of the other one. The line is marched through the SDF: cells far from walls
+// let the march skip ahead, close to walls it visits every cell the line touches.
+int IsLineWalkable(const PathGrid *grid, int fromX, int fromY, int toX, int toY, int unitSize);
+
+// removes the path nodes that can be skipped by walking straight from an earlier node to a
+// later one (string pulling) and returns the new number of nodes. The path is changed in
+// place, the first and last node stay.
+int SmoothPath(const PathGrid *grid, PathPoint *path, int pathCount, int unitSize);
+
+// smoothes the path of the agent after a search; the path no longer follows the wall factor
+// between the nodes that are left, but it is still walkable for the unit size
+void Agent_smoothPath(Agent *agent);
+
+// samples a Catmull-Rom spline through the centers of the path cells, in cell units, and
+// returns the number of points written. Segments where a sample lies in a cell that is
+// too narrow for the unit stay straight lines.
+int SamplePathSpline(const PathGrid *grid, const PathPoint *path, int pathCount, int unitSize, int samplesPerSegment, Vector2 *points, int maxPointCount);
+
+#endif
@@ -0,0 +1,790 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - pathfinding core
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "pathfinding.h"
+#include "sdf.h"
+#include "incremental_planner.h"
+#include "clearance_labels.h"
+
+#include <stdlib.h> // Required for: malloc, free
+#include <string.h> // Required for: memset
+#include <math.h> // Required for: sqrtf, ceilf
+#include <limits.h> // Required for: INT_MAX
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #define NOMINMAX
+    #include <windows.h> // Required for: InitOnceExecuteOnce
+#else
+    #include <pthread.h> // Required for: pthread_once
+#endif
+
+#if defined(PATH_SIMD_AVX2)
+    #include <immintrin.h> // Required for: AVX2 intrinsics
+#elif defined(PATH_SIMD_SSE4)
+    #include <smmintrin.h> // Required for: SSE4.1 intrinsics
+#endif
+
+int isqrt[256] = {0};
+
+NeighborOffset neighborOffsets[PATH_NEIGHBOR_OFFSET_CAPACITY] = {0};
+int neighborOffsetCount = 0;
+
+// the neighbor offsets a search checks for each max step distance, in the order of
+// neighborOffsets so the results don't depend on how they are evaluated. The lists of all
+// distances follow each other, each one starts at a multiple of the kernel width and is
+// padded with offsets to the cell itself, so the kernels only load whole vectors.
+#define STEP_OFFSET_KERNEL_WIDTH 8
+#define STEP_OFFSET_CAPACITY (PATH_MAX_STEP_DISTANCE * (PATH_NEIGHBOR_OFFSET_CAPACITY + STEP_OFFSET_KERNEL_WIDTH))
+static int stepOffsetStarts[PATH_MAX_STEP_DISTANCE + 1];
+static int stepOffsetCounts[PATH_MAX_STEP_DISTANCE + 1];
+static int stepOffsetIndices[STEP_OFFSET_CAPACITY];
+static int stepOffsetDistances[STEP_OFFSET_CAPACITY];
+
+#if defined(_MSC_VER)
+    #define PATH_THREAD_LOCAL __declspec(thread)
+#else
+    #define PATH_THREAD_LOCAL _Thread_local
+#endif
+
+// each thread searches with its own arena, so the searches of a batch don't share memory
+static PATH_THREAD_LOCAL PathSearchArena threadArena = { 0 };
+
+static void BuildLookupTables(void)
+{
+    // initialize square root lookup table for cheap square root calculation
+    for (int i=0;i<256;i++)
+    {
+        isqrt[i] = (int)ceilf(sqrtf(i));
+    }
+
+    for (int x = -PATH_MAX_STEP_DISTANCE; x <= PATH_MAX_STEP_DISTANCE; x++)
+    {
+        for (int y = -PATH_MAX_STEP_DISTANCE; y <= PATH_MAX_STEP_DISTANCE; y++)
+        {
+            int d = isqrt[x * x + y * y];
+            if (d <= PATH_MAX_STEP_DISTANCE && d > 0)
+            {
+                neighborOffsets[neighborOffsetCount] = (NeighborOffset){ x, y, d };
+                neighborOffsetCount++;
+            }
+        }
+    }
+
+    int stepOffsetCount = 0;
+    for (int maxDistance = 1; maxDistance <= PATH_MAX_STEP_DISTANCE; maxDistance++)
+    {
+        stepOffsetStarts[maxDistance] = stepOffsetCount;
+        for (int i = 0; i < neighborOffsetCount; i++)
+        {
+            if (neighborOffsets[i].distance <= maxDistance)
+            {
+                stepOffsetIndices[stepOffsetCount] = i;
+                stepOffsetDistances[stepOffsetCount] = neighborOffsets[i].distance;
+                stepOffsetCount++;
+            }
+        }
+        stepOffsetCounts[maxDistance] = stepOffsetCount - stepOffsetStarts[maxDistance];
+        while (stepOffsetCount % STEP_OFFSET_KERNEL_WIDTH != 0)
+        {
+            stepOffsetIndices[stepOffsetCount] = -1;
+            stepOffsetDistances[stepOffsetCount] = 0;
+            stepOffsetCount++;
+        }
+    }
+}
+
+// the tables are shared by all grids, grids may be created on several threads at the same
+// time and none of them may see the tables half built
+#if defined(_WIN32)
+static INIT_ONCE lookupTablesOnce = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK BuildLookupTablesOnce(PINIT_ONCE once, PVOID parameter, PVOID *context)
+{
+    (void)once;
+    (void)parameter;
+    (void)context;
+    BuildLookupTables();
+    return TRUE;
+}
+#else
+static pthread_once_t lookupTablesOnce = PTHREAD_ONCE_INIT;
+#endif
+
+static void InitLookupTables(void)
+{
+#if defined(_WIN32)
+    InitOnceExecuteOnce(&lookupTablesOnce, BuildLookupTablesOnce, NULL, NULL);
+#else
+    pthread_once(&lookupTablesOnce, BuildLookupTables);
+#endif
+}
+
+//------------------------------------------------------------------------------------
+// grids
+//------------------------------------------------------------------------------------
+PathGrid *PathGrid_create(int width, int height)
+{
+    InitLookupTables();
+
+    PathGrid *grid = (PathGrid *)RL_CALLOC(1, sizeof(PathGrid));
+    grid->width = width;
+    grid->height = height;
+    grid->blockedCells = (char *)RL_CALLOC(width * height, sizeof(char));
+    // one more value than cells: the AVX2 kernel reads the SDF values as 32 bit values
+    grid->sdfCells = (unsigned short *)RL_CALLOC(width * height + 1, sizeof(unsigned short));
+    return grid;
+}
+
+PathGrid *PathGrid_createFromPixels(const Color *pixels, int width, int height)
+{
+    PathGrid *grid = PathGrid_create(width, height);
+    for (int i = 0; i < width * height; i++)
+    {
+        // transparent pixels are free, opaque ones are walls if they are darker than half gray
+        Color pixel = pixels[i];
+        int brightness = (pixel.r * 299 + pixel.g * 587 + pixel.b * 114) / 1000;
+        grid->blockedCells[i] = pixel.a >= 128 && brightness < 128 ? 1 : 0;
+    }
+    return grid;
+}
+
+void PathGrid_destroy(PathGrid *grid)
+{
+    UnloadSDFState(grid);
+    PathGrid_disableClearanceLabels(grid);
+    RL_FREE(grid->blockedCells);
+    RL_FREE(grid->sdfCells);
+    RL_FREE(grid);
+}
+
+int clamp(int value, int min, int max)
+{
+    if (value < min) return min;
+    if (value > max) return max;
+    return value;
+}
+
+//------------------------------------------------------------------------------------
+// search results
+//------------------------------------------------------------------------------------
+PathMap PathMap_init(int cellCount)
+{
+    PathMap map;
+    map.parents = (unsigned int *)RL_MALLOC(cellCount * sizeof(unsigned int));
+    map.scores = (int *)RL_MALLOC(cellCount * sizeof(int));
+    map.generations = (unsigned int *)RL_CALLOC(cellCount, sizeof(unsigned int));
+    map.generation = 1;
+    map.cellCount = cellCount;
+    return map;
+}
+
+void PathMap_free(PathMap *map)
+{
+    RL_FREE(map->parents);
+    RL_FREE(map->scores);
+    RL_FREE(map->generations);
+    map->parents = NULL;
+    map->scores = NULL;
+    map->generations = NULL;
+}
+
+void PathMap_reset(PathMap *map)
+{
+    map->generation++;
+    if (map->generation == 0)
+    {
+        // after 4 billion searches the stamps of old searches could match again
+        memset(map->generations, 0, map->cellCount * sizeof(unsigned int));
+        map->generation = 1;
+    }
+}
+
+//------------------------------------------------------------------------------------
+// open list
+//------------------------------------------------------------------------------------
+PathHeap PathHeap_init(int cellCount)
+{
+    PathHeap heap;
+    // every cell is queued at most once, so the heap can't be longer than the number of cells
+    heap.entries = (PathHeapEntry *)RL_MALLOC(cellCount * sizeof(PathHeapEntry));
+    heap.positions = (int *)RL_MALLOC(cellCount * sizeof(int));
+    heap.count = 0;
+    for (int i = 0; i < cellCount; i++)
+    {
+        heap.positions[i] = -1;
+    }
+    return heap;
+}
+
+void PathHeap_free(PathHeap *heap)
+{
+    RL_FREE(heap->entries);
+    RL_FREE(heap->positions);
+    heap->entries = NULL;
+    heap->positions = NULL;
+    heap->count = 0;
+}
+
+// moves the entry towards the root until its parent has a lower or equal score
+static void PathHeap_siftUp(PathHeap *heap, int position, PathHeapEntry entry)
+{
+    while (position > 0)
+    {
+        int parent = (position - 1) / 2;
+        if (heap->entries[parent].score <= entry.score)
+        {
+            break;
+        }
+        heap->entries[position] = heap->entries[parent];
+        heap->positions[heap->entries[position].cell] = position;
+        position = parent;
+    }
+    heap->entries[position] = entry;
+    heap->positions[entry.cell] = position;
+}
+
+// moves the entry towards the leaves until both children have a higher or equal score
+static void PathHeap_siftDown(PathHeap *heap, int position, PathHeapEntry entry)
+{
+    while (1)
+    {
+        int child = position * 2 + 1;
+        if (child >= heap->count)
+        {
+            break;
+        }
+        if (child + 1 < heap->count && heap->entries[child + 1].score < heap->entries[child].score)
+        {
+            child++;
+        }
+        if (heap->entries[child].score >= entry.score)
+        {
+            break;
+        }
+        heap->entries[position] = heap->entries[child];
+        heap->positions[heap->entries[position].cell] = position;
+        position = child;
+    }
+    heap->entries[position] = entry;
+    heap->positions[entry.cell] = position;
+}
+
+void PathHeap_push(PathHeap *heap, int cell, int score)
+{
+    PathHeapEntry entry = { score, cell };
+    int position = heap->positions[cell];
+    if (position < 0)
+    {
+        position = heap->count++;
+    }
+    else if (score > heap->entries[position].score)
+    {
+        PathHeap_siftDown(heap, position, entry);
+        return;
+    }
+    PathHeap_siftUp(heap, position, entry);
+}
+
+int PathHeap_pop(PathHeap *heap)
+{
+    int cell = heap->entries[0].cell;
+    heap->positions[cell] = -1;
+    heap->count--;
+    if (heap->count > 0)
+    {
+        PathHeap_siftDown(heap, 0, heap->entries[heap->count]);
+    }
+    return cell;
+}
+
+void PathHeap_clear(PathHeap *heap)
+{
+    for (int i = 0; i < heap->count; i++)
+    {
+        heap->positions[heap->entries[i].cell] = -1;
+    }
+    heap->count = 0;
+}
+
+void PathHeap_remove(PathHeap *heap, int cell)
+{
+    int position = heap->positions[cell];
+    heap->positions[cell] = -1;
+    heap->count--;
+    if (position == heap->count)
+    {
+        return;
+    }
+    // the last entry takes the free position and moves up or down from there
+    PathHeapEntry last = heap->entries[heap->count];
+    if (position > 0 && heap->entries[(position - 1) / 2].score > last.score)
+    {
+        PathHeap_siftUp(heap, position, last);
+    }
+    else
+    {
+        PathHeap_siftDown(heap, position, last);
+    }
+}
+
+PathSearchArena *PathSearchArena_get(int cellCount)
+{
+    if (threadArena.cellCount < cellCount)
+    {
+        PathSearchArena_releaseThread();
+        threadArena.cellCount = cellCount;
+        threadArena.queue = PathHeap_init(threadArena.cellCount);
+    }
+    return &threadArena;
+}
+
+void PathSearchArena_releaseThread(void)
+{
+    // searches with their own open list only use the step offsets of the arena
+    if (threadArena.cellCount > 0)
+    {
+        PathHeap_free(&threadArena.queue);
+        threadArena.cellCount = 0;
+    }
+    RL_FREE(threadArena.stepOffsetDeltas);
+    threadArena.stepOffsetDeltas = NULL;
+    threadArena.stepOffsetGridWidth = 0;
+}
+
+// the step offsets as index deltas for the width of the grid, only computed again when a
+// search on a grid of another width follows
+static const int *PathSearchArena_getStepOffsetDeltas(PathSearchArena *arena, int gridWidth)
+{
+    if (arena->stepOffsetGridWidth == gridWidth)
+    {
+        return arena->stepOffsetDeltas;
+    }
+    if (arena->stepOffsetDeltas == NULL)
+    {
+        arena->stepOffsetDeltas = (int *)RL_MALLOC(STEP_OFFSET_CAPACITY * sizeof(int));
+    }
+    for (int i = 0; i < STEP_OFFSET_CAPACITY; i++)
+    {
+        int index = stepOffsetIndices[i];
+        arena->stepOffsetDeltas[i] = index < 0 ? 0 : neighborOffsets[index].y * gridWidth + neighborOffsets[index].x;
+    }
+    arena->stepOffsetGridWidth = gridWidth;
+    return arena->stepOffsetDeltas;
+}
+
+//------------------------------------------------------------------------------------
+// neighbor evaluation
+//------------------------------------------------------------------------------------
+// a cell the search takes from the open list and the unit it searches for
+typedef struct NeighborQuery
+{
+    int cell;
+    int cellScore;
+    int cellSdf;
+    int unitSize;
+    int wallFactor;
+} NeighborQuery;
+
+// neighbors of a cell whose score the step from the cell improves, in the order of the offsets
+typedef struct NeighborResult
+{
+    int cells[PATH_NEIGHBOR_OFFSET_CAPACITY + STEP_OFFSET_KERNEL_WIDTH];
+    int scores[PATH_NEIGHBOR_OFFSET_CAPACITY + STEP_OFFSET_KERNEL_WIDTH];
+    int count;
+} NeighborResult;
+
+// evaluates the offsets of a cell close to the border, every neighbor is checked to be on the grid
+static void EvaluateBorderNeighbors(const PathGrid *grid, const PathMap *map, NeighborQuery query, int first, int count, NeighborResult *result)
+{
+    int cellX = query.cell % grid->width;
+    int cellY = query.cell / grid->width;
+    for (int i = first; i < first + count; i++)
+    {
+        // rejecting first cells that are outside the map
+        int x = cellX + neighborOffsets[stepOffsetIndices[i]].x;
+        int y = cellY + neighborOffsets[stepOffsetIndices[i]].y;
+        if (!PathGrid_contains(grid, x, y))
+        {
+            continue;
+        }
+
+        // skip if the next cell is closer to a wall than the unit size (wall clipping)
+        int next = y * grid->width + x;
+        int nextSdf = grid->sdfCells[next];
+        if (nextSdf < query.unitSize)
+        {
+            continue;
+        }
+
+        int score = query.cellScore + PathStepScore(query.cellSdf, nextSdf, stepOffsetDistances[i], query.wallFactor);
+        int nextScore = PathMap_score(map, next);
+        if (nextScore == 0 || score < nextScore)
+        {
+            result->cells[result->count] = next;
+            result->scores[result->count] = score;
+            result->count++;
+        }
+    }
+}
+
+// evaluates the offsets of a cell that is so far from the border that all of them are on the grid
+static void EvaluateNeighbors(const unsigned short *sdfCells, const PathMap *map, const int *deltas, NeighborQuery query, int first, int count, NeighborResult *result)
+{
+    for (int i = first; i < first + count; i++)
+    {
+        int next = query.cell + deltas[i];
+        int nextSdf = sdfCells[next];
+        if (nextSdf < query.unitSize)
+        {
+            continue;
+        }
+
+        int score = query.cellScore + PathStepScore(query.cellSdf, nextSdf, stepOffsetDistances[i], query.wallFactor);
+        int nextScore = PathMap_score(map, next);
+        if (nextScore == 0 || score < nextScore)
+        {
+            result->cells[result->count] = next;
+            result->scores[result->count] = score;
+            result->count++;
+        }
+    }
+}
+
+#if defined(PATH_SIMD_AVX2) || defined(PATH_SIMD_SSE4)
+// the kernels divide by 6 in floats, which truncates like the integer division as long as
+// the product of the integrated SDF value and the wall factor stays far below 2^21
+#define SIMD_KERNEL_MAX_WALL_FACTOR 1024
+#endif
+
+#if defined(PATH_SIMD_AVX2)
+// EvaluateNeighbors for 8 offsets per iteration: the SDF values, generation stamps and
+// scores of the neighbors are gathered, PathStepScore is computed for all of them and the
+// improved ones are written to the result in the order of their lanes
+static void EvaluateNeighborsSimd(const unsigned short *sdfCells, const PathMap *map, const int *deltas, NeighborQuery query, int first, int count, NeighborResult *result)
+{
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i cell = _mm256_set1_epi32(query.cell);
+    const __m256i cellScore = _mm256_set1_epi32(query.cellScore);
+    const __m256i minSdf = _mm256_set1_epi32(query.unitSize - 1);
+    const __m256i cellSdfValue = _mm256_set1_epi32(query.cellSdf < SDF_WALL_FACTOR_RANGE ? query.cellSdf : SDF_WALL_FACTOR_RANGE);
+    const __m256i sdfRange = _mm256_set1_epi32(SDF_WALL_FACTOR_RANGE);
+    const __m256i wallFactor = _mm256_set1_epi32(query.wallFactor);
+    const __m256i generation = _mm256_set1_epi32((int)map->generation);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 six = _mm256_set1_ps(6.0f);
+
+    for (int i = 0; i < count; i += 8)
+    {
+        __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - i), lanes);
+        __m256i stepDistance = _mm256_loadu_si256((const __m256i *)(stepOffsetDistances + first + i));
+        __m256i next = _mm256_add_epi32(cell, _mm256_loadu_si256((const __m256i *)(deltas + first + i)));
+
+        // skip if the next cell is closer to a wall than the unit size (wall clipping)
+        __m256i nextSdf = _mm256_and_si256(_mm256_i32gather_epi32((const int *)sdfCells, next, 2), _mm256_set1_epi32(0xffff));
+        __m256i passable = _mm256_and_si256(valid, _mm256_cmpgt_epi32(nextSdf, minSdf));
+        if (_mm256_testz_si256(passable, passable))
+        {
+            continue;
+        }
+
+        // PathStepScore, the integrated value is never negative so the shift divides by 2
+        __m256i sdfValue = _mm256_min_epi32(nextSdf, sdfRange);
+        __m256i integrated = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_add_epi32(sdfValue, cellSdfValue), _mm256_add_epi32(stepDistance, one)), 1);
+        __m256i weighted = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_mullo_epi32(integrated, wallFactor)), six));
+        __m256i score = _mm256_add_epi32(cellScore, _mm256_add_epi32(stepDistance, weighted));
+
+        // PathMap_score: cells of older searches count as unreached
+        __m256i stamps = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int *)map->generations, next, passable, 4);
+        __m256i scores = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), map->scores, next, passable, 4);
+        __m256i reached = _mm256_cmpeq_epi32(stamps, generation);
+        __m256i notImproved = _mm256_andnot_si256(_mm256_cmpgt_epi32(scores, score), reached);
+        __m256i improves = _mm256_andnot_si256(notImproved, passable);
+
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(improves));
+        if (mask == 0)
+        {
+            continue;
+        }
+        int nextCells[8];
+        int nextScores[8];
+        _mm256_storeu_si256((__m256i *)nextCells, next);
+        _mm256_storeu_si256((__m256i *)nextScores, score);
+        for (int lane = 0; lane < 8; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                result->cells[result->count] = nextCells[lane];
+                result->scores[result->count] = nextScores[lane];
+                result->count++;
+            }
+        }
+    }
+}
+#elif defined(PATH_SIMD_SSE4)
+// EvaluateNeighbors for 4 offsets per iteration; SSE has no gathers, the values of the
+// neighbors are loaded one by one and PathStepScore and the comparisons run on all of them
+static void EvaluateNeighborsSimd(const unsigned short *sdfCells, const PathMap *map, const int *deltas, NeighborQuery query, int first, int count, NeighborResult *result)
+{
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i cellScore = _mm_set1_epi32(query.cellScore);
+    const __m128i minSdf = _mm_set1_epi32(query.unitSize - 1);
+    const __m128i cellSdfValue = _mm_set1_epi32(query.cellSdf < SDF_WALL_FACTOR_RANGE ? query.cellSdf : SDF_WALL_FACTOR_RANGE);
+    const __m128i sdfRange = _mm_set1_epi32(SDF_WALL_FACTOR_RANGE);
+    const __m128i wallFactor = _mm_set1_epi32(query.wallFactor);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128 six = _mm_set1_ps(6.0f);
+
+    for (int i = 0; i < count; i += 4)
+    {
+        int next[4];
+        for (int lane = 0; lane < 4; lane++)
+        {
+            next[lane] = query.cell + deltas[first + i + lane];
+        }
+        __m128i valid = _mm_cmpgt_epi32(_mm_set1_epi32(count - i), lanes);
+        __m128i stepDistance = _mm_loadu_si128((const __m128i *)(stepOffsetDistances + first + i));
+
+        // skip if the next cell is closer to a wall than the unit size (wall clipping)
+        __m128i nextSdf = _mm_setr_epi32(sdfCells[next[0]], sdfCells[next[1]], sdfCells[next[2]], sdfCells[next[3]]);
+        __m128i passable = _mm_and_si128(valid, _mm_cmpgt_epi32(nextSdf, minSdf));
+        if (_mm_testz_si128(passable, passable))
+        {
+            continue;
+        }
+
+        // PathStepScore, the integrated value is never negative so the shift divides by 2
+        __m128i sdfValue = _mm_min_epi32(nextSdf, sdfRange);
+        __m128i integrated = _mm_srli_epi32(_mm_mullo_epi32(_mm_add_epi32(sdfValue, cellSdfValue), _mm_add_epi32(stepDistance, one)), 1);
+        __m128i weighted = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_mullo_epi32(integrated, wallFactor)), six));
+        __m128i score = _mm_add_epi32(cellScore, _mm_add_epi32(stepDistance, weighted));
+
+        int passableMask = _mm_movemask_ps(_mm_castsi128_ps(passable));
+        int nextScores[4];
+        _mm_storeu_si128((__m128i *)nextScores, score);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (passableMask & (1 << lane))
+            {
+                int nextScore = PathMap_score(map, next[lane]);
+                if (nextScore == 0 || nextScores[lane] < nextScore)
+                {
+                    result->cells[result->count] = next[lane];
+                    result->scores[result->count] = nextScores[lane];
+                    result->count++;
+                }
+            }
+        }
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------------
+// agents
+//------------------------------------------------------------------------------------
+Agent Agent_init(PathGrid *grid, int x, int y, int size, int targetX, int targetY, int wallFactor, Vector2* icon, int iconCount, Color color)
+{
+    Agent agent;
+    agent.grid = grid;
+    agent.unitSize = size;
+    agent.startX = x;
+    agent.startY = y;
+    agent.targetX = targetX;
+    agent.targetY = targetY;
+    agent.pathCount = 0;
+    agent.pathScore = 0;
+    agent.wallFactor = wallFactor;
+    agent.path = (PathPoint *)RL_MALLOC(grid->width * grid->height * sizeof(PathPoint));
+    agent.map = PathMap_init(grid->width * grid->height);
+    agent.icon = icon;
+    agent.color = color;
+    agent.iconCount = iconCount;
+    agent.walkedPathDistance = 0.0f;
+    agent.expandedCount = 0;
+    agent.planner = NULL;
+    return agent;
+
+}
+
+void Agent_free(Agent *agent)
+{
+    if (agent->planner != NULL)
+    {
+        IncrementalPlanner_free(agent);
+    }
+    RL_FREE(agent->path);
+    PathMap_free(&agent->map);
+    agent->path = NULL;
+    agent->pathCount = 0;
+}
+
+int ExtractPath(const PathGrid *grid, const PathMap *map, int fromX, int fromY, int toX, int toY, PathPoint *path)
+{
+    int gridWidth = grid->width;
+    int cell = fromY * gridWidth + fromX;
+    int toCell = toY * gridWidth + toX;
+    if (PathMap_score(map, cell) == 0)
+    {
+        // no path found
+        return 0;
+    }
+
+    // path found
+    int length = 0;
+    // reconstruct path by following the parents to previous cells - the list is reversed
+    // but we handle this with swapping the start / end points
+    while (PathMap_score(map, cell) > 0 && cell != toCell && length < map->cellCount - 1)
+    {
+        path[length++] = (PathPoint){ cell % gridWidth, cell / gridWidth };
+        cell = map->parents[cell];
+    }
+    path[length++] = (PathPoint){ toX, toY };
+    return length;
+}
+
+void Agent_extractPath(Agent *agent)
+{
+    // the search runs from the target to the start, see Agent_findPath
+    agent->pathCount = ExtractPath(agent->grid, &agent->map, agent->startX, agent->startY, agent->targetX, agent->targetY, agent->path);
+    agent->pathScore = PathMap_score(&agent->map, agent->startY * agent->grid->width + agent->startX);
+}
+
+PathSearch PathSearch_begin(const Agent *agent, PathMap *map, PathHeap *queue, int enableJumping)
+{
+    PathSearch search = { agent->grid, map, queue, agent->unitSize, agent->wallFactor, enableJumping, 0 };
+    // we swap the start and end points to get the path in the right order without reversing it
+    // so it searches from the target to the start and not the other way round, but in this case,
+    // this doesn't matter
+    int startCell = agent->targetY * agent->grid->width + agent->targetX;
+    PathMap_reset(map);
+    if (!PathGrid_isReachable(agent->grid, agent->unitSize, agent->startX, agent->startY, agent->targetX, agent->targetY))
+    {
+        return search;
+    }
+
+    // initialize queue and map with start position data
+    PathMap_set(map, startCell, PATH_NO_PARENT, 1);
+    PathHeap_push(queue, startCell, 1);
+    return search;
+}
+
+int PathSearch_run(PathSearch *search, int maxExpandedCount)
+{
+    // the grid is read into locals, the compiler can't know that writing the map leaves it alone
+    const PathGrid *grid = search->grid;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    const unsigned short *sdfCells = grid->sdfCells;
+    // the open list of the search is its own, only the step offsets come from the arena
+    const int *stepOffsetDeltas = PathSearchArena_getStepOffsetDeltas(PathSearchArena_get(0), gridWidth);
+    NeighborResult neighbors;
+    PathMap *map = search->map;
+    PathHeap *queue = search->queue;
+    int unitSize = search->unitSize;
+    int sdfFactor = search->wallFactor;
+    int enableJumping = search->enableJumping;
+
+    int expandedCount = 0;
+    while (queue->count > 0 && expandedCount < maxExpandedCount)
+    {
+        // dequeue node with lowest score
+        int cell = PathHeap_pop(queue);
+        int cellX = cell % gridWidth;
+        int cellY = cell / gridWidth;
+        int cellScore = map->scores[cell];
+        expandedCount++;
+
+        int cellSdf = sdfCells[cell];
+        int maxDistance = enableJumping ? PathMaxStepDistance(cellSdf, unitSize) : 1;
+        maxDistance = maxDistance < PATH_MAX_STEP_DISTANCE ? maxDistance : PATH_MAX_STEP_DISTANCE;
+
+        // The step offsets are the neighbor offsets up to the max distance, cells further
+        // from the border than that don't need to check whether the neighbors are on the map
+        NeighborQuery query = { cell, cellScore, cellSdf, unitSize, sdfFactor };
+        int first = stepOffsetStarts[maxDistance];
+        int count = stepOffsetCounts[maxDistance];
+        neighbors.count = 0;
+        if (cellX < maxDistance || cellX >= gridWidth - maxDistance || cellY < maxDistance || cellY >= gridHeight - maxDistance)
+        {
+            EvaluateBorderNeighbors(grid, map, query, first, count, &neighbors);
+        }
+#if defined(PATH_SIMD_AVX2) || defined(PATH_SIMD_SSE4)
+        else if (sdfFactor >= -SIMD_KERNEL_MAX_WALL_FACTOR && sdfFactor <= SIMD_KERNEL_MAX_WALL_FACTOR)
+        {
+            EvaluateNeighborsSimd(sdfCells, map, stepOffsetDeltas, query, first, count, &neighbors);
+        }
+#endif
+        else
+        {
+            EvaluateNeighbors(sdfCells, map, stepOffsetDeltas, query, first, count, &neighbors);
+        }
+
+        // if the cell is not yet visited or the score is lower than the previous score,
+        // we update the cell and queue the cell for evaluation - a cell that is already
+        // queued is moved up in the queue instead of being queued a second time
+        for (int i = 0; i < neighbors.count; i++)
+        {
+            PathMap_set(map, neighbors.cells[i], cell, neighbors.scores[i]);
+            PathHeap_push(queue, neighbors.cells[i], neighbors.scores[i]);
+        }
+    }
+    search->expandedCount += expandedCount;
+    return queue->count == 0;
+}
+
+void Agent_findPath(Agent *agent, int enableJumping)
+{
+    PathHeap *queue = &PathSearchArena_get(agent->grid->width * agent->grid->height)->queue;
+    PathSearch search = PathSearch_begin(agent, &agent->map, queue, enableJumping);
+    PathSearch_run(&search, INT_MAX);
+    agent->expandedCount = search.expandedCount;
+    Agent_extractPath(agent);
+
+    if (agent->planner != NULL)
+    {
+        IncrementalPlanner_sync(agent, enableJumping);
+    }
+}
+
+float CalcPathLength(PathPoint* path, int pathCount)
+{
+    float length = 0.0f;
+    for (int i=1;i<pathCount;i++)
+    {
+        PathPoint p1 = path[i-1];
+        PathPoint p2 = path[i];
+        float dx = (float)p2.x - p1.x;
+        float dy = (float)p2.y - p1.y;
+        length += sqrtf(dx * dx + dy * dy);
+    }
+    return length;
+}
@@ -0,0 +1,261 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - pathfinding core
+*
+*   The core only uses raylib types and allocation macros but no raylib functions, so
+*   it can be built into the headless benchmark that runs without opening a window.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef PATHFINDING_H
+#define PATHFINDING_H
+
+#include "raylib.h"
+
+// the SDF values are not capped, but the wall factor of agents only weighs distances up to
+// this value, so a wall factor has the same effect in open areas of any size
+#define SDF_WALL_FACTOR_RANGE 10
+
+// parent of the cell a search started at
+#define PATH_NO_PARENT 0xffffffffu
+
+// the longest step a search with jumping takes, the neighbor offsets reach this far
+#define PATH_MAX_STEP_DISTANCE 10
+#define PATH_NEIGHBOR_OFFSET_CAPACITY ((2 * PATH_MAX_STEP_DISTANCE + 1) * (2 * PATH_MAX_STEP_DISTANCE + 1))
+
+// the neighbors of a cell are evaluated with AVX2 or SSE4.1 if the compiler targets them
+// (premake option --simd), define PATH_SIMD_DISABLED to use the scalar code in any case
+#if !defined(PATH_SIMD_DISABLED) && defined(__AVX2__)
+    #define PATH_SIMD_AVX2
+#elif !defined(PATH_SIMD_DISABLED) && defined(__SSE4_1__)
+    #define PATH_SIMD_SSE4
+#endif
+
+struct SDFState;
+struct ClearanceLabels;
+
+// a map that can be searched: its size, its walls and the SDF of the walls. Any number of
+// grids can exist at the same time; agents and everything derived from a grid keep a
+// pointer to the grid they belong to, so searches on different grids can run in parallel.
+typedef struct PathGrid
+{
+    int width, height;
+    char *blockedCells;
+    unsigned short *sdfCells;
+    // cells whose SDF value was changed by the last UpdateSDFCells call
+    int *sdfChangedCells;
+    int sdfChangedCount;
+    // incremented whenever any SDF value changes, data derived from the SDF can store it to
+    // detect that it is outdated
+    int sdfVersion;
+    // the closest walls and queue of the incremental SDF update, NULL until the SDF is computed
+    struct SDFState *sdfState;
+    // connected areas per unit size, NULL unless PathGrid_enableClearanceLabels was called
+    struct ClearanceLabels *clearanceLabels;
+} PathGrid;
+
+// a cell of a path
+typedef struct PathPoint
+{
+    unsigned short x, y;
+} PathPoint;
+
+// the result of a search, one array per field so a search only touches the data it
+// needs. Each search has a new generation and a cell is only reached by the current
+// search if its generation stamp matches, so a search doesn't clear the map before it
+// starts. The scores start at 1 at the cell the search started at, the parent of a cell
+// is the index of the cell its path continues with towards that cell.
+typedef struct PathMap
+{
+    unsigned int *parents;
+    int *scores;
+    unsigned int *generations;
+    unsigned int generation;
+    int cellCount;
+} PathMap;
+
+typedef struct NeighborOffset
+{
+    int x, y;
+    int distance;
+} NeighborOffset;
+
+struct IncrementalPlanner;
+
+typedef struct Agent
+{
+    PathGrid *grid;
+    int startX, startY;
+    int targetX, targetY;
+    int wallFactor;
+    int unitSize;
+    // the cells from the start to the target, a shortest path can't be longer than the
+    // number of cells
+    PathPoint *path;
+    int pathCount;
+    // score of the start cell, the cost of the path plus 1
+    int pathScore;
+    PathMap map;
+    Vector2* icon;
+    Color color;
+    int iconCount;
+    float walkedPathDistance;
+    // number of nodes taken from the open list during the last search
+    int expandedCount;
+    // search state kept between searches, NULL unless the incremental planner is enabled
+    struct IncrementalPlanner *planner;
+} Agent;
+
+typedef struct PathHeapEntry
+{
+    int score;
+    int cell;
+} PathHeapEntry;
+
+// binary min heap used as open list: a cell is queued at most once, pushing a cell that
+// is already queued moves it to its new position instead of adding it a second time
+typedef struct PathHeap
+{
+    PathHeapEntry *entries;
+    // position of each cell in the entries array, -1 if the cell is not queued
+    int *positions;
+    int count;
+} PathHeap;
+
+// memory a search needs besides the agent's map, reused by all searches of a thread so a
+// search doesn't allocate anything. The open list is empty between searches, which means
+// all its positions are -1 and it can be used without initializing it again.
+typedef struct PathSearchArena
+{
+    PathHeap queue;
+    int cellCount;
+    // the neighbor offsets of the search as index deltas, for grids of the given width
+    int *stepOffsetDeltas;
+    int stepOffsetGridWidth;
+} PathSearchArena;
+
+// a search of Agent_findPath that can stop after any number of expanded nodes and continue
+// later. It runs from the target of the agent to its start and has its own map and open
+// list; the map holds the result once the open list is empty. The SDF of the grid must not
+// change while the search is unfinished.
+typedef struct PathSearch
+{
+    const PathGrid *grid;
+    PathMap *map;
+    PathHeap *queue;
+    int unitSize;
+    int wallFactor;
+    int enableJumping;
+    // number of nodes taken from the open list so far
+    int expandedCount;
+} PathSearch;
+
+// we can determine how far we can safely jump away from a cell by taking the SDF value
+// of the cell. If our unit size is 2 and the SDF value is 5, we can safely jump 3 cells
+// away from this cell, knowing that we can't clip through walls at this distance.
+// The SDF values used to be capped at 10, which limited steps to 10 - unitSize cells. The
+// SDF is uncapped now, so in open areas the searches step up to PATH_MAX_STEP_DISTANCE
+// cells for every unit size, and the paths and scores differ from the capped SDF.
+static inline int PathMaxStepDistance(int cellSdf, int unitSize)
+{
+    int maxDistance = cellSdf - unitSize;
+    return maxDistance < 1 ? 1 : maxDistance;
+}
+
+// score of a step from a cell to a neighbor cell at the given step distance
+static inline int PathStepScore(int cellSdf, int nextSdf, int stepDistance, int wallFactor)
+{
+    int cellSdfValue = cellSdf < SDF_WALL_FACTOR_RANGE ? cellSdf : SDF_WALL_FACTOR_RANGE;
+    int sdfValue = nextSdf < SDF_WALL_FACTOR_RANGE ? nextSdf : SDF_WALL_FACTOR_RANGE;
+    // assuming a linear interpolation between the SDF values of the current and next cell,
+    // we can estimate the integral of the SDF values between the two cells - this is
+    // only a rough approximation and since it's integers, we cheat a bit to favor longer jumps
+    int integratedSdfValue = (sdfValue + cellSdfValue) * (stepDistance + 1) / 2;
+    return stepDistance + integratedSdfValue * wallFactor / 6;
+}
+
+// score of a cell in the current search, 0 if the search didn't reach it
+static inline int PathMap_score(const PathMap *map, int cell)
+{
+    return map->generations[cell] == map->generation ? map->scores[cell] : 0;
+}
+
+static inline unsigned int PathMap_parent(const PathMap *map, int cell)
+{
+    return map->generations[cell] == map->generation ? map->parents[cell] : PATH_NO_PARENT;
+}
+
+static inline void PathMap_set(PathMap *map, int cell, unsigned int parent, int score)
+{
+    map->generations[cell] = map->generation;
+    map->parents[cell] = parent;
+    map->scores[cell] = score;
+}
+
+// lookup table for cheap square root calculation
+extern int isqrt[256];
+
+// various offsets and distances for jumping nodes during pathfinding, the lookup tables
+// are the same for all grids and are filled when the first grid is created
+extern NeighborOffset neighborOffsets[PATH_NEIGHBOR_OFFSET_CAPACITY];
+extern int neighborOffsetCount;
+
+// allocates a grid without walls, the SDF has to be computed before searching it
+PathGrid *PathGrid_create(int width, int height);
+// creates a grid from the pixels of an image: dark pixels become walls
+PathGrid *PathGrid_createFromPixels(const Color *pixels, int width, int height);
+void PathGrid_destroy(PathGrid *grid);
+
+static inline int PathGrid_contains(const PathGrid *grid, int x, int y)
+{
+    return x >= 0 && x < grid->width && y >= 0 && y < grid->height;
+}
+
+int clamp(int value, int min, int max);
+
+PathMap PathMap_init(int cellCount);
+void PathMap_free(PathMap *map);
+// starts a new search, all cells are unreached afterwards
+void PathMap_reset(PathMap *map);
+
+PathHeap PathHeap_init(int cellCount);
+void PathHeap_free(PathHeap *heap);
+void PathHeap_push(PathHeap *heap, int cell, int score);
+int PathHeap_pop(PathHeap *heap);
+void PathHeap_remove(PathHeap *heap, int cell);
+// removes all entries, for searches that stop before the open list is empty
+void PathHeap_clear(PathHeap *heap);
+
+// the arena of the calling thread for a grid with the given number of cells, allocated on
+// first use and grown for larger grids, so it serves the grids of any size
+PathSearchArena *PathSearchArena_get(int cellCount);
+// frees the arena of the calling thread, threads that ran searches call this before ending
+void PathSearchArena_releaseThread(void);
+
+Agent Agent_init(PathGrid *grid, int x, int y, int size, int targetX, int targetY, int wallFactor, Vector2* icon, int iconCount, Color color);
+void Agent_free(Agent *agent);
+void Agent_findPath(Agent *agent, int enableJumping);
+
+// resets the map and queues the target of the agent, the queue must be empty and have room
+// for all cells of the grid. If the clearance labels of the grid tell that the start can't
+// be reached, nothing is queued and the search is done right away with no cell reached.
+PathSearch PathSearch_begin(const Agent *agent, PathMap *map, PathHeap *queue, int enableJumping);
+// expands up to maxExpandedCount nodes, returns 1 when the open list is empty and the search
+// is done
+int PathSearch_run(PathSearch *search, int maxExpandedCount);
+// follows the parents in the map from the start of the agent to its target
+void Agent_extractPath(Agent *agent);
+
+// follows the parents of a searched map from a cell to the cell the search started at and
+// returns the number of path cells, 0 if the cell wasn't reached
+int ExtractPath(const PathGrid *grid, const PathMap *map, int fromX, int fromY, int toX, int toY, PathPoint *path);
+
+float CalcPathLength(PathPoint* path, int pathCount);
+
+#endif
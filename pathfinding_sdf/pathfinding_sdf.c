@@ -40,46 +40,36 @@
 *   3) Varying step distances: Using SDF values to adjust step distances during path 
 *      finding, resulting in curved paths.
 *
-*  TODO: optimize the path after it was found: nodes could be removed to smooth the path
-*        this could again be done using the SDF values to determine if a node can be removed
-*        without clipping through walls
+*   4) Path smoothing: Nodes are removed from the path if the unit can walk straight past
+*      them, which is checked by marching through the SDF values.
 *
 ********************************************************************************************/
 
 #include "raylib.h"
 #include "raymath.h"
 
-#include <stddef.h> // Required for: NULL
-#include <math.h> // Required for: abs
-
-typedef struct PathfindingNode
-{
-    int x, y;
-    int fromX;
-    int fromY;
-    int score;
-} PathfindingNode;
+#include "pathfinding.h"
+#include "sdf.h"
+#include "incremental_planner.h"
+#include "path_batch.h"
+#include "flow_field.h"
+#include "path_smoothing.h"
+#include "path_request.h"
+#include "clearance_labels.h"
 
-typedef struct NeighborOffset
-{
-    int x, y;
-    int distance;
-} NeighborOffset;
+#include <stddef.h> // Required for: NULL
+#include <stdlib.h> // Required for: malloc, free
+#include <math.h> // Required for: sqrtf
 
-typedef struct Agent
+// a color per grid cell, kept in a texture that is drawn as a single quad scaled to the
+// cell size. The pixels stay on the CPU so changed rectangles can be uploaded on their own.
+typedef struct CellTexture
 {
-    int startX, startY;
-    int targetX, targetY;
-    int wallFactor;
-    int unitSize;
-    PathfindingNode *path;
-    int pathCount;
-    PathfindingNode *map;
-    Vector2* icon;
-    Color color;
-    int iconCount;
-    float walkedPathDistance;
-} Agent;
+    Texture2D texture;
+    int width, height;
+    Color *pixels;
+    Color *uploadPixels;
+} CellTexture;
 
 typedef struct AppState
 {
@@ -87,11 +77,32 @@ typedef struct AppState
     int randomizeBlocks;
     char paintMode;
     int updateSDF;
+    // painted cells are patched into the SDF instead of recalculating all of it
+    int patchSDF;
     int sdfFunction;
     int jumpingEnabled;
+    // agents follow shared flow fields instead of searching their own paths
+    int flowFieldEnabled;
+    // paths are smoothed after each search and drawn as splines
+    int smoothPathsEnabled;
+    // searches run a slice per frame instead of all at once, the agents keep their old
+    // paths until the new ones land
+    int timeSlicingEnabled;
     int cellX, cellY;
+    PathGrid *grid;
     Agent rat;
     Agent cat;
+    PathWorkerPool *workers;
+    PathRequestQueue *pathRequests;
+    PathRequestHandle ratRequest;
+    PathRequestHandle catRequest;
+    FlowFieldCache flowFields;
+    // walls and SDF values, the searched scores of an agent and the grid lines
+    CellTexture mapTexture;
+    CellTexture pathMapTexture;
+    // map the path map texture shows, it is only filled again when the paths changed
+    const PathMap *pathMapTextureSource;
+    Texture2D gridLineTexture;
 } AppState;
 
 // a simple cat face that can be drawn as a triangle fan
@@ -129,194 +140,11 @@ Vector2 ratFace[] = {
 const Color gridColor = { 200, 200, 200, 40 };
 const Color cellHighlightColor = { 200, 0, 0, 80 };
 const float movementSpeed = 3.0f;
+// time per frame the time sliced searches may take
+const int pathSearchBudgetMicroseconds = 2000;
 
-const int gridWidth = 80;
-const int gridHeight = 45;
-const int cellSize = 10;
-
-char* blockedCells = NULL;
-char* sdfCells = NULL;
-
-// lookup table for cheap square root calculation
-int isqrt[256] = {0};
-
-// various offsets and distances for jumping nodes during pathfinding
-NeighborOffset neighborOffsets[20*20] = {0};
-int neighborOffsetCount = 0;
-
-Agent Agent_init(int x, int y, int size, int targetX, int targetY, int wallFactor, Vector2* icon, int iconCount, Color color)
-{
-    Agent agent;
-    agent.unitSize = size;
-    agent.startX = x;
-    agent.startY = y;
-    agent.targetX = targetX;
-    agent.targetY = targetY;
-    agent.pathCount = 0;
-    agent.wallFactor = wallFactor;
-    agent.path = (PathfindingNode *)MemAlloc(gridWidth * gridHeight * sizeof(PathfindingNode) * 4);
-    agent.map = (PathfindingNode *)MemAlloc(gridWidth * gridHeight * sizeof(PathfindingNode));
-    agent.icon = icon;
-    agent.color = color;
-    agent.iconCount = iconCount;
-    agent.walkedPathDistance = 0.0f;
-    return agent;
-
-}
-
-void Agent_findPath(Agent *agent, int enableJumping)
-{
-    // the queue should in theory not be longer than the number of map cells
-    PathfindingNode *queue = (PathfindingNode *)MemAlloc(gridWidth * gridHeight * sizeof(PathfindingNode));
-    PathfindingNode *map = agent->map;
-    PathfindingNode *path = agent->path;
-    int unitSize = agent->unitSize;
-    int sdfFactor = agent->wallFactor;
-    // we swap the start and end points to get the path in the right order without reversing it
-    // so it searches from the target to the start and not the other way round, but in this case,
-    // this doesn't matter
-    int toX = agent->startX;
-    int toY = agent->startY;
-    int startX = agent->targetX;
-    int startY = agent->targetY;
-    for (int i = 0; i < gridWidth * gridHeight; i++)
-    {
-        map[i].score = 0;
-    }
-
-    // initialize queue and map with start position data
-    int queueLength = 1;
-    queue[0].fromX = startX;
-    queue[0].fromY = startY;
-    queue[0].x = startX;
-    queue[0].y = startY;
-    queue[0].score = 1;
-    map[startY * gridWidth + startX].fromX = -1;
-    map[startY * gridWidth + startX].fromY = -1;
-    map[startY * gridWidth + startX].x = startX;
-    map[startY * gridWidth + startX].y = startY;
-    map[startY * gridWidth + startX].score = 1;
-
-    while (queueLength > 0)
-    {
-        // find and dequeue node with lowest score
-        int lowestScoreIndex = 0;
-        for (int i=1;i<queueLength;i++)
-        {
-            if (queue[i].score < queue[lowestScoreIndex].score)
-            {
-                lowestScoreIndex = i;
-            }
-        }
-        PathfindingNode node = queue[lowestScoreIndex];
-        for (int i=lowestScoreIndex+1;i<queueLength;i++)
-        {
-            queue[i-1] = queue[i];
-        }
-        queueLength--;
-
-        // we can determine how far we can safely jump away from this cell by 
-        // taking the SDF value of the current cell. If our unit size is 2 and 
-        // the SDF value is 5, we can safely jump 3 cells away from this cell, knowing
-        // that we can't clip through walls at this distance.
-        int cellSdf = sdfCells[node.y * gridWidth + node.x];
-        int maxDistance = cellSdf - agent->unitSize;
-        if (maxDistance < 1)
-        {
-            maxDistance = 1;
-        }
-
-        // The neighbor offsets are used to check various directions of different distances
-        for (int i=0; i<neighborOffsetCount; i++)
-        {
-            // step distance is the distance the offset is away from the current cell
-            // if it exceeds the max distance, we skip this offset
-            int stepDistance = neighborOffsets[i].distance;
-            if (stepDistance > maxDistance || (!enableJumping && stepDistance > 1))
-            {
-                continue;
-            }
-
-            // rejecting first cells that are outside the map
-            int x = node.x + neighborOffsets[i].x;
-            int y = node.y + neighborOffsets[i].y;
-            if (x < 0 || x >= gridWidth || y < 0 || y >= gridHeight)
-            {
-                continue;
-            }
-
-            // nextSdf is the SDF value of the next cell where we would land
-            int nextSdf = sdfCells[y * gridWidth + x];
-
-            // skip if the next cell is closer to a wall than the unit size (wall clipping)
-            if (nextSdf < unitSize)
-            {
-                continue;
-            }
-
-            // calculate the score of the next cell
-            int score = node.score + stepDistance;
-            int sdfValue = sdfCells[y * gridWidth + x];
-            // assuming a linear interpolation between the SDF values of the current and next cell,
-            // we can estimate the integral of the SDF values between the two cells - this is
-            // only a rough approximation and since it's integers, we cheat a bit to favor longer jumps
-            int integratedSdfValue = (sdfValue + cellSdf) * (stepDistance + 1) / 2;
-            score = score + integratedSdfValue * sdfFactor / 6;
-
-            // if the cell is not yet visited or the score is lower than the previous score, 
-            // we update the cell and queue the cell for evaluation (one optimization would be to
-            // not queue the cell if it is already queued, but this complexity is omitted here)
-            if (map[y * gridWidth + x].score == 0 || score < map[y * gridWidth + x].score)
-            {
-                map[y * gridWidth + x] = (PathfindingNode){
-                    .fromX = node.x,
-                    .fromY = node.y,
-                    .x = x,
-                    .y = y,
-                    .score = score
-                };
-                // queue the cell for evaluation
-                queue[queueLength] = map[y * gridWidth + x];
-                queueLength++;
-
-                // prevent queue overflow - should not happen with the chosen queue lengths, but
-                // could (maybe) still happen for extreme worst case scenarios
-                if (queueLength >= gridWidth * gridHeight)
-                {
-                    TraceLog(LOG_ERROR, "queue overflow\n");
-                    queueLength = gridWidth * gridHeight - 1;
-                }
-            }
-        }
-    }
-
-    if (map[toY * gridWidth + toX].score > 0)
-    {
-        // path found
-        int x = toX;
-        int y = toY;
-        int length = 0;
-        // reconstruct path by following the from pointers to previous cells - the list is reversed
-        // but we handle this with swapping the start / end points
-        while (map[y * gridWidth + x].score > 0 && (x != startX || y != startY) && length < gridWidth * gridHeight)
-        {
-            path[length] = map[y * gridWidth + x];
-            x = path[length].fromX;
-            y = path[length].fromY;
-            length++;
-        }
-        path[length++] = map[startY * gridWidth + startX];
-        
-        agent->pathCount = length;
-    }
-    else
-    {
-        // no path found
-        agent->pathCount = 0;
-    }
-
-    MemFree(queue);
-}
+// pixels per cell, the map is scaled to fit into the window when it is loaded
+int cellSize = 10;
 
 void Agent_drawPath(Agent *agent)
 {
@@ -335,6 +163,17 @@ void Agent_drawPath(Agent *agent)
     }
 }
 
+void Agent_drawPathSpline(Agent *agent)
+{
+    Vector2 points[512];
+    int pointCount = SamplePathSpline(agent->grid, agent->path, agent->pathCount, agent->unitSize, 8, points, 512);
+    for (int i = 0; i < pointCount; i++)
+    {
+        points[i] = Vector2Scale(points[i], (float)cellSize);
+    }
+    DrawLineStrip(points, pointCount, agent->color);
+}
+
 void Agent_drawPathMovement(Agent *agent)
 {
     int pathCount = agent->pathCount;
@@ -343,7 +182,7 @@ void Agent_drawPathMovement(Agent *agent)
         return;
     }
 
-    PathfindingNode* path = agent->path;
+    PathPoint* path = agent->path;
     int pointCount = agent->iconCount;
     Vector2* points = agent->icon;
     float radius = agent->unitSize * cellSize / 2.0f;
@@ -354,10 +193,10 @@ void Agent_drawPathMovement(Agent *agent)
     float pointDistance = 0.0f;
     for (int i=1;i<pathCount;i++)
     {
-        PathfindingNode p1 = path[i-1];
-        PathfindingNode p2 = path[i];
-        float dx = p2.x - p1.x;
-        float dy = p2.y - p1.y;
+        PathPoint p1 = path[i-1];
+        PathPoint p2 = path[i];
+        float dx = (float)p2.x - p1.x;
+        float dy = (float)p2.y - p1.y;
         float d = sqrtf(dx * dx + dy * dy);
         if (pointDistance + d >= agent->walkedPathDistance)
         {
@@ -386,22 +225,130 @@ void Agent_drawPathMovement(Agent *agent)
     agent->walkedPathDistance = 0.0f;
 } 
 
-float CalcPathLength(PathfindingNode* path, int pathCount)
+CellTexture CellTexture_init(int width, int height)
 {
-    float length = 0.0f;
-    for (int i=1;i<pathCount;i++)
+    CellTexture cellTexture = { 0 };
+    cellTexture.width = width;
+    cellTexture.height = height;
+    cellTexture.pixels = (Color *)RL_CALLOC(width * height, sizeof(Color));
+    cellTexture.uploadPixels = (Color *)RL_MALLOC(width * height * sizeof(Color));
+    Image image = GenImageColor(width, height, BLANK);
+    cellTexture.texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    return cellTexture;
+}
+
+void CellTexture_free(CellTexture *cellTexture)
+{
+    UnloadTexture(cellTexture->texture);
+    RL_FREE(cellTexture->pixels);
+    RL_FREE(cellTexture->uploadPixels);
+    cellTexture->pixels = NULL;
+    cellTexture->uploadPixels = NULL;
+}
+
+// uploads the pixels of the cells from minX, minY to maxX, maxY
+void CellTexture_upload(CellTexture *cellTexture, int minX, int minY, int maxX, int maxY)
+{
+    int width = maxX - minX + 1;
+    int height = maxY - minY + 1;
+    const Color *pixels = cellTexture->pixels + minY * cellTexture->width;
+    if (width < cellTexture->width)
+    {
+        // UpdateTextureRec takes the rows of the rectangle without gaps between them
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                cellTexture->uploadPixels[y * width + x] = cellTexture->pixels[(minY + y) * cellTexture->width + minX + x];
+            }
+        }
+        pixels = cellTexture->uploadPixels;
+    }
+    UpdateTextureRec(cellTexture->texture, (Rectangle){ minX, minY, width, height }, pixels);
+}
+
+void CellTexture_draw(const CellTexture *cellTexture)
+{
+    DrawTexturePro(cellTexture->texture, (Rectangle){ 0, 0, cellTexture->width, cellTexture->height },
+        (Rectangle){ 0, 0, cellTexture->width * cellSize, cellTexture->height * cellSize }, (Vector2){ 0, 0 }, 0.0f, WHITE);
+}
+
+// one cell of the grid lines, the texture repeats when it is drawn larger than itself
+Texture2D LoadGridLineTexture(int size)
+{
+    Image image = GenImageColor(size, size, BLANK);
+    ImageDrawRectangle(&image, 0, 0, size, 1, gridColor);
+    ImageDrawRectangle(&image, 0, 0, 1, size, gridColor);
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    SetTextureWrap(texture, TEXTURE_WRAP_REPEAT);
+    return texture;
+}
+
+// blocked cells black, the sdf values as transparent dark overlay (the further away from
+// walls, the brighter). The overlay is blended into the walls, so each cell is one pixel.
+Color MapCellColor(const PathGrid *grid, int cell)
+{
+    int sdf = clamp(grid->sdfCells[cell], 0, 10);
+    unsigned char alpha = 230 - sdf * 20;
+    if (grid->blockedCells[cell] == 1)
+    {
+        unsigned char c = 32 * alpha / 255;
+        return (Color){ c, c, c, 255 };
+    }
+    return (Color){ 32, 32, 32, alpha };
+}
+
+// updates the map texture for the given cells, or all cells if cells is NULL; only the
+// rectangle around the cells is uploaded
+void UpdateMapTexture(CellTexture *mapTexture, const PathGrid *grid, const int *cells, int cellCount)
+{
+    if (cells == NULL)
+    {
+        for (int i = 0; i < grid->width * grid->height; i++)
+        {
+            mapTexture->pixels[i] = MapCellColor(grid, i);
+        }
+        CellTexture_upload(mapTexture, 0, 0, grid->width - 1, grid->height - 1);
+        return;
+    }
+    if (cellCount == 0)
+    {
+        return;
+    }
+
+    int minX = grid->width, minY = grid->height, maxX = 0, maxY = 0;
+    for (int i = 0; i < cellCount; i++)
+    {
+        int x = cells[i] % grid->width;
+        int y = cells[i] / grid->width;
+        minX = x < minX ? x : minX;
+        minY = y < minY ? y : minY;
+        maxX = x > maxX ? x : maxX;
+        maxY = y > maxY ? y : maxY;
+        mapTexture->pixels[cells[i]] = MapCellColor(grid, cells[i]);
+    }
+    CellTexture_upload(mapTexture, minX, minY, maxX, maxY);
+}
+
+// the scores of the cells a search reached, as yellow stripes
+void UpdatePathMapTexture(CellTexture *pathMapTexture, const PathMap *pathToDraw)
+{
+    for (int i = 0; i < pathToDraw->cellCount; i++)
     {
-        PathfindingNode p1 = path[i-1];
-        PathfindingNode p2 = path[i];
-        float dx = p2.x - p1.x;
-        float dy = p2.y - p1.y;
-        length += sqrtf(dx * dx + dy * dy);
+        int score = PathMap_score(pathToDraw, i);
+        int c = score % 64 * 4;
+        pathMapTexture->pixels[i] = score > 0 ? (Color){ c, c, 0, 128 } : BLANK;
     }
-    return length;
+    CellTexture_upload(pathMapTexture, 0, 0, pathMapTexture->width - 1, pathMapTexture->height - 1);
 }
 
+void AppState_loadMap(AppState *appState, const char *fileName);
+
 void AppState_handleInput(AppState *appState)
 {
+    PathGrid *grid = appState->grid;
     Vector2 mousePos = GetMousePosition();
     int cellX = mousePos.x / cellSize;
     int cellY = mousePos.y / cellSize;
@@ -411,14 +358,14 @@ void AppState_handleInput(AppState *appState)
     //----------------------------------------------------------------------------------
     // mouse input handling
     //----------------------------------------------------------------------------------
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && PathGrid_contains(grid, cellX, cellY))
     {
-        appState->paintMode = blockedCells[cellY * gridWidth + cellX] == 1 ? 0 : 1;
+        appState->paintMode = grid->blockedCells[cellY * grid->width + cellX] == 1 ? 0 : 1;
     }
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON))
     {
-        blockedCells[cellY * gridWidth + cellX] = appState->paintMode;
-        appState->updateSDF = 1;
+        SetCellBlocked(grid, cellX, cellY, appState->paintMode);
+        appState->patchSDF = 1;
     }
 
     //----------------------------------------------------------------------------------
@@ -426,9 +373,9 @@ void AppState_handleInput(AppState *appState)
     //----------------------------------------------------------------------------------
     if (IsKeyDown(KEY_C)) 
     {
-        for (int i = 0; i < gridWidth * gridHeight; i++)
+        for (int i = 0; i < grid->width * grid->height; i++)
         {
-            blockedCells[i] = 0;
+            grid->blockedCells[i] = 0;
         }
         appState->updateSDF = 1;
     }
@@ -460,148 +407,197 @@ void AppState_handleInput(AppState *appState)
         appState->jumpingEnabled = !appState->jumpingEnabled;
         appState->updateSDF = 1;
     }
+
+    if (IsKeyPressed(KEY_F))
+    {
+        appState->flowFieldEnabled = !appState->flowFieldEnabled;
+        appState->updateSDF = 1;
+    }
+
+    if (IsFileDropped())
+    {
+        FilePathList files = LoadDroppedFiles();
+        AppState_loadMap(appState, files.paths[0]);
+        UnloadDroppedFiles(files);
+    }
+
+    if (IsKeyPressed(KEY_P))
+    {
+        appState->smoothPathsEnabled = !appState->smoothPathsEnabled;
+        appState->updateSDF = 1;
+    }
+
+    if (IsKeyPressed(KEY_T))
+    {
+        appState->timeSlicingEnabled = !appState->timeSlicingEnabled;
+        appState->updateSDF = 1;
+    }
 }
 
 void AppState_randomizeBlocks(AppState *appState)
 {
+    PathGrid *grid = appState->grid;
     appState->updateSDF = 1;
-    for (int i = 0; i < gridWidth * gridHeight; i++)
+    for (int i = 0; i < grid->width * grid->height; i++)
     {
-        blockedCells[i] = 0;
+        grid->blockedCells[i] = 0;
     }
-    for (int i=0;i<40;i++)
+    // 40 blocks on the 80x45 map, and as many per area on maps of other sizes
+    int blockCount = 40 * grid->width * grid->height / (80 * 45);
+    for (int i=0;i<blockCount;i++)
     {
-        int x = GetRandomValue(15, gridWidth-15);
-        int y = GetRandomValue(15, gridHeight-15);
+        int x = GetRandomValue(15, grid->width-15);
+        int y = GetRandomValue(15, grid->height-15);
         int size = GetRandomValue(1, 2);
         int blockValue = GetRandomValue(0, 1);
         for (int j=-size;j<=size;j++)
         {
             for (int k=-size;k<=size;k++)
             {
-                blockedCells[(y+j)*gridWidth + x+k] = blockValue;
+                if (PathGrid_contains(grid, x+k, y+j))
+                {
+                    grid->blockedCells[(y+j)*grid->width + x+k] = blockValue;
+                }
             }
         }
     }
 }
 
-int clamp(int value, int min, int max)
+// replaces the map, the agents and everything else that belongs to the old grid
+void AppState_setGrid(AppState *appState, PathGrid *grid)
+{
+    if (appState->grid != NULL)
+    {
+        PathRequestQueue_cancel(appState->pathRequests, &appState->rat);
+        PathRequestQueue_cancel(appState->pathRequests, &appState->cat);
+        FlowFieldCache_free(&appState->flowFields);
+        CellTexture_free(&appState->mapTexture);
+        CellTexture_free(&appState->pathMapTexture);
+        UnloadTexture(appState->gridLineTexture);
+        Agent_free(&appState->rat);
+        Agent_free(&appState->cat);
+        PathGrid_destroy(appState->grid);
+    }
+    appState->grid = grid;
+    // the rat and the cat have unit sizes 1 and 2, targets they can't reach are rejected
+    // without searching
+    PathGrid_enableClearanceLabels(grid, 2);
+
+    // the agents run from the left to the right side of the map
+    int startX = grid->width > 5 ? 5 : grid->width - 1;
+    int targetX = grid->width > 5 ? grid->width - 5 : 0;
+    int y = grid->height > 25 ? 25 : grid->height / 2;
+    appState->rat = Agent_init(grid, startX, y, 1, targetX, y, 2, ratFace, sizeof(ratFace) / sizeof(ratFace[0]), RED);
+    appState->cat = Agent_init(grid, startX, y, 2, targetX, y, 0, catFace, sizeof(catFace) / sizeof(catFace[0]), BLUE);
+    Agent_enableIncrementalPlanner(&appState->rat);
+    Agent_enableIncrementalPlanner(&appState->cat);
+    appState->flowFields = FlowFieldCache_init(grid, 4);
+
+    // cells are scaled to fill the window, large maps are drawn with a pixel per cell
+    int cellWidth = GetScreenWidth() / grid->width;
+    int cellHeight = GetScreenHeight() / grid->height;
+    cellSize = cellWidth < cellHeight ? cellWidth : cellHeight;
+    cellSize = cellSize < 1 ? 1 : cellSize;
+    appState->mapTexture = CellTexture_init(grid->width, grid->height);
+    appState->pathMapTexture = CellTexture_init(grid->width, grid->height);
+    appState->pathMapTextureSource = NULL;
+    appState->gridLineTexture = LoadGridLineTexture(cellSize);
+    appState->updateSDF = 1;
+}
+
+// loads a map from an image file: dark pixels are walls, transparent and bright ones are free
+void AppState_loadMap(AppState *appState, const char *fileName)
+{
+    Image image = LoadImage(fileName);
+    if (image.data == NULL)
+    {
+        return;
+    }
+    Color *pixels = LoadImageColors(image);
+    AppState_setGrid(appState, PathGrid_createFromPixels(pixels, image.width, image.height));
+    UnloadImageColors(pixels);
+    UnloadImage(image);
+    appState->randomizeBlocks = 0;
+}
+
+void AppState_followFlowFields(AppState *appState)
 {
-    if (value < min) return min;
-    if (value > max) return max;
-    return value;
+    // the cache only searches again if the SDF changed since the field was searched
+    Agent_followFlowField(&appState->rat, FlowFieldCache_getForAgent(&appState->flowFields, &appState->rat, appState->jumpingEnabled));
+    Agent_followFlowField(&appState->cat, FlowFieldCache_getForAgent(&appState->flowFields, &appState->cat, appState->jumpingEnabled));
 }
 
 void AppState_updateSDF(AppState *appState)
 {
-    // calculate sdf values
-    // update sdf values to max distance we want to consider
-    for (int i = 0; i < gridWidth * gridHeight; i++)
+    ComputeSDF(appState->grid, appState->sdfFunction);
+    if (appState->flowFieldEnabled || !appState->timeSlicingEnabled)
+    {
+        // a pending search would land later and replace the paths found now
+        PathRequestQueue_cancel(appState->pathRequests, &appState->rat);
+        PathRequestQueue_cancel(appState->pathRequests, &appState->cat);
+    }
+    if (appState->flowFieldEnabled)
     {
-        sdfCells[i] = 10;
+        AppState_followFlowFields(appState);
+        return;
     }
-    
-    int sdfFunction = appState->sdfFunction;
 
-    for (int y = 0; y < gridHeight; y++)
+    if (appState->timeSlicingEnabled)
     {
-        for (int x = 0; x < gridWidth; x++)
-        {
-            // for each cell, we update the surrounding cells with the distance to this wall
-            // doing this brutally simple, for big maps this is inefficient
-            if (blockedCells[y * gridWidth + x] == 1)
-            {
-                sdfCells[y * gridWidth + x] = 0;
-                int minX = clamp(x - 10, 0, gridWidth - 1);
-                int minY = clamp(y - 10, 0, gridHeight - 1);
-                int maxX = clamp(x + 10, 0, gridWidth - 1);
-                int maxY = clamp(y + 10, 0, gridHeight - 1);
-                // update surrounding cells up to max distance we want to consider
-                for (int j = minY; j <= maxY; j++)
-                {
-                    for (int i = minX; i <= maxX; i++)
-                    {
-                        int dx = x - i;
-                        int dy = y - j;
-                        int d = 0;
-                        if (sdfFunction == 0)
-                        {
-                            // euclidean distance
-                            d = isqrt[dx * dx + dy * dy];
-                        }
-                        else if (sdfFunction == 1)
-                        {
-                            // chebyshev distance
-                            d = (abs(dx) < abs(dy)) ? abs(dy) : abs(dx);
-                        }
-                        else if (sdfFunction == 2)
-                        {
-                            // manhattan distance
-                            d = abs(dx) + abs(dy);
-                        }
-
-                        if (d < sdfCells[j*gridWidth + i] && d < 10)
-                        {
-                            sdfCells[j*gridWidth + i] = d;
-                        }
-                    }
-                }
-            }
-        }
+        // the searches run in the following frames, see the main loop
+        appState->ratRequest = PathRequestQueue_request(appState->pathRequests, &appState->rat, appState->jumpingEnabled);
+        appState->catRequest = PathRequestQueue_request(appState->pathRequests, &appState->cat, appState->jumpingEnabled);
+        return;
     }
 
-    // trigger path finding for both agents
-    Agent_findPath(&appState->rat, appState->jumpingEnabled);
-    Agent_findPath(&appState->cat, appState->jumpingEnabled);
+    // trigger path finding for both agents, each on its own thread
+    Agent *agents[] = { &appState->rat, &appState->cat };
+    Agent_findPathBatch(appState->workers, agents, 2, appState->jumpingEnabled);
 }
 
-void DrawMapContent()
+void AppState_patchSDF(AppState *appState)
 {
-    for (int y = 0; y < gridHeight; y++)
+    // only the cells around the painted cells are updated, and the agents only repair
+    // the parts of their maps that depend on the changed cells
+    PathGrid *grid = appState->grid;
+    if (UpdateSDFCells(grid) == 0)
     {
-        for (int x = 0; x < gridWidth; x++)
-        {
-            // blocked cells black
-            if (blockedCells[y * gridWidth + x] == 1) 
-            {
-                DrawRectangle(x * cellSize, y * cellSize, cellSize, cellSize, BLACK);
-            }
-
-            // sdf values as transparent blue (the further away from wals, the brighter)
-            int sdf = sdfCells[y * gridWidth + x];
-            DrawRectangle(x*cellSize, y * cellSize, cellSize, cellSize, (Color){ 32, 32, 32, 230-sdf * 20});
-        }
+        return;
+    }
+    if (appState->flowFieldEnabled)
+    {
+        AppState_followFlowFields(appState);
+        return;
+    }
+    // agents with a pending search get a path for the patched SDF when it lands, the search
+    // starts over when the SDF changed
+    if (PathRequestQueue_status(appState->pathRequests, appState->ratRequest) != PATH_REQUEST_PENDING)
+    {
+        Agent_replan(&appState->rat, appState->jumpingEnabled, grid->sdfChangedCells, grid->sdfChangedCount);
+    }
+    if (PathRequestQueue_status(appState->pathRequests, appState->catRequest) != PATH_REQUEST_PENDING)
+    {
+        Agent_replan(&appState->cat, appState->jumpingEnabled, grid->sdfChangedCells, grid->sdfChangedCount);
     }
 }
 
-void DrawPathMapVisualization(PathfindingNode* pathToDraw)
+// draws the path that a unit of the rat's class would take from the given cell
+void DrawFlowFieldPath(const FlowField *field, int x, int y, Color color)
 {
-    int scoreMax = 0;
-    for (int i = 0; i<gridWidth*gridHeight; i++)
-    {
-        if (pathToDraw[i].score > scoreMax)
-        {
-            scoreMax = pathToDraw[i].score;
-        }
-    }
-    for (int y = 0; y < gridHeight; y++)
+    int nextX, nextY;
+    for (int i = 0; i < field->search.map.cellCount && FlowField_nextCell(field, x, y, &nextX, &nextY); i++)
     {
-        for (int x = 0; x < gridWidth; x++)
-        {
-            if (pathToDraw[y * gridWidth + x].score > 0)
-            {
-                int score = pathToDraw[y * gridWidth + x].score;
-                int c = score % 64 * 4;
-                DrawRectangle(x*cellSize, y * cellSize, cellSize, cellSize, (Color){ c, c, 0, 128 });
-            }
-        }
+        DrawLine(x * cellSize + cellSize / 2, y * cellSize + cellSize / 2,
+            nextX * cellSize + cellSize / 2, nextY * cellSize + cellSize / 2, color);
+        x = nextX;
+        y = nextY;
     }
 }
 
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char **argv)
 {
     SetTraceLogLevel(LOG_ALL);
     // Initialization
@@ -613,39 +609,30 @@ int main(void)
 
     SetTargetFPS(60);
 
-    // initialize square root lookup table for cheap square root calculation
-    for (int i=0;i<256;i++)
-    {
-        isqrt[i] = (int)ceilf(sqrtf(i));
-    }
-
-    for (int x = -10; x <= 10; x++)
-    {
-        for (int y = -10; y <= 10; y++)
-        {
-            int d = isqrt[x * x + y * y];
-            if (d <= 10 && d > 0)
-            {
-                neighborOffsets[neighborOffsetCount] = (NeighborOffset){ x, y, d };
-                neighborOffsetCount++;
-            }
-        }
-    }
-
-    blockedCells = (char *)MemAlloc(gridWidth * gridHeight * sizeof(char));
-    sdfCells = (char *)MemAlloc(gridWidth * gridHeight * sizeof(char));
-
     AppState appState = {
         .visualizeMode = 0,
         .randomizeBlocks = 1,
         .paintMode = 0,
         .updateSDF = 1,
+        .patchSDF = 0,
         .sdfFunction = 0,
         .jumpingEnabled = 1,
-        .rat = Agent_init(5, 25, 1, 75, 25, 2, ratFace, sizeof(ratFace) / sizeof(ratFace[0]), RED),
-        .cat = Agent_init(5, 25, 2, 75, 25, 0, catFace, sizeof(catFace) / sizeof(catFace[0]), BLUE),
+        .flowFieldEnabled = 0,
+        .smoothPathsEnabled = 0,
+        .timeSlicingEnabled = 1,
+        .grid = NULL,
+        .workers = PathWorkerPool_create(2),
+        .pathRequests = PathRequestQueue_create(),
+        .ratRequest = { -1, 0 },
+        .catRequest = { -1, 0 },
     };
-    
+
+    // a map image can be passed on the command line or dropped onto the window
+    AppState_setGrid(&appState, PathGrid_create(80, 45));
+    if (argc > 1)
+    {
+        AppState_loadMap(&appState, argv[1]);
+    }
     //--------------------------------------------------------------------------------------
 
     // Main game loop
@@ -672,57 +659,96 @@ int main(void)
             //----------------------------------------------------------------------------------
             // update sdf values and execute pathfinding
             //----------------------------------------------------------------------------------
+            int pathsUpdated = appState.updateSDF || appState.patchSDF;
             if (appState.updateSDF)
             {
                 appState.updateSDF = 0;
+                appState.patchSDF = 0;
                 AppState_updateSDF(&appState);
+                UpdateMapTexture(&appState.mapTexture, appState.grid, NULL, 0);
+            }
+            else if (appState.patchSDF)
+            {
+                appState.patchSDF = 0;
+                AppState_patchSDF(&appState);
+                UpdateMapTexture(&appState.mapTexture, appState.grid, appState.grid->sdfChangedCells, appState.grid->sdfChangedCount);
+            }
+
+            // searches that didn't fit into the budget continue in the next frame
+            if (PathRequestQueue_update(appState.pathRequests, pathSearchBudgetMicroseconds) > 0)
+            {
+                pathsUpdated = 1;
+            }
+
+            // the paths are smoothed after they were searched or repaired
+            if (appState.smoothPathsEnabled && pathsUpdated)
+            {
+                Agent_smoothPath(&appState.rat);
+                Agent_smoothPath(&appState.cat);
             }
 
             //----------------------------------------------------------------------------------
             // draw cell content of walls and sdf values
             //----------------------------------------------------------------------------------
-            DrawMapContent();
+            CellTexture_draw(&appState.mapTexture);
 
             //----------------------------------------------------------------------------------
             // draw rat pathfinding score data for visualization
             //----------------------------------------------------------------------------------
-            PathfindingNode* pathToDraw = NULL;
+            const PathMap* pathToDraw = NULL;
             switch (appState.visualizeMode % 3)
             {
                 case 1: // visualize rat map
-                    pathToDraw = appState.rat.map;
+                    pathToDraw = &appState.rat.map;
                     break;
                 case 2: // visualize cat map
-                    pathToDraw = appState.cat.map;
+                    pathToDraw = &appState.cat.map;
                     break;
             }
+            if (pathToDraw != NULL && appState.flowFieldEnabled)
+            {
+                // the maps of the agents aren't searched in flow field mode
+                Agent *agent = appState.visualizeMode % 3 == 1 ? &appState.rat : &appState.cat;
+                pathToDraw = &FlowFieldCache_getForAgent(&appState.flowFields, agent, appState.jumpingEnabled)->search.map;
+            }
 
             if (pathToDraw != NULL)
             {
-                DrawPathMapVisualization(pathToDraw);
+                if (pathsUpdated || pathToDraw != appState.pathMapTextureSource)
+                {
+                    UpdatePathMapTexture(&appState.pathMapTexture, pathToDraw);
+                }
+                CellTexture_draw(&appState.pathMapTexture);
             }
+            appState.pathMapTextureSource = pathToDraw;
 
             //----------------------------------------------------------------------------------
             // draw grid lines
             //----------------------------------------------------------------------------------
-            for (int y = 0; y < gridHeight; y++)
-            {
-                DrawRectangle(0, y * cellSize, gridWidth*cellSize, 1, gridColor);
-            }
-            for (int x = 0; x < gridWidth; x++)
-            {
-                DrawRectangle(x*cellSize, 0, 1, gridHeight*cellSize, gridColor);
-            }
+            DrawTextureRec(appState.gridLineTexture, (Rectangle){ 0, 0, appState.grid->width * cellSize, appState.grid->height * cellSize },
+                (Vector2){ 0, 0 }, WHITE);
 
             // highlight current cell the mouse is over
             DrawRectangle(appState.cellX * cellSize, appState.cellY * cellSize, cellSize, cellSize, cellHighlightColor);
 
+            // any cell can look up its way to the target in the flow field, no search needed
+            if (appState.flowFieldEnabled && PathGrid_contains(appState.grid, appState.cellX, appState.cellY))
+            {
+                const FlowField *field = FlowFieldCache_getForAgent(&appState.flowFields, &appState.rat, appState.jumpingEnabled);
+                DrawFlowFieldPath(field, appState.cellX, appState.cellY, Fade(RED, 0.5f));
+            }
+
 
             //----------------------------------------------------------------------------------
             // draw paths of cat and rat
             //----------------------------------------------------------------------------------
             Agent_drawPath(&appState.rat);
             Agent_drawPath(&appState.cat);
+            if (appState.smoothPathsEnabled)
+            {
+                Agent_drawPathSpline(&appState.rat);
+                Agent_drawPathSpline(&appState.cat);
+            }
 
             //----------------------------------------------------------------------------------
             // draw animated movement of rat and cat
@@ -740,6 +766,11 @@ int main(void)
                 CalcPathLength(appState.rat.path, appState.rat.pathCount), 
                 CalcPathLength(appState.cat.path, appState.rat.pathCount)), 
                 10, GetScreenHeight() - 100, 20, BLACK);
+            DrawText(TextFormat("T: time sliced searches (current: %s, %d pending)", appState.timeSlicingEnabled ? "yes" : "no",
+                PathRequestQueue_pendingCount(appState.pathRequests)), 10, GetScreenHeight() - 160, 20, BLACK);
+            DrawText(TextFormat("P: smooth paths (current: %s)", appState.smoothPathsEnabled ? "yes" : "no"), 10, GetScreenHeight() - 140, 20, BLACK);
+            DrawText(TextFormat("F: shared flow fields (current: %s, %d searches, %d cache hits)", appState.flowFieldEnabled ? "yes" : "no",
+                appState.flowFields.missCount, appState.flowFields.hitCount), 10, GetScreenHeight() - 120, 20, BLACK);
             DrawText(TextFormat("R: randomize blocks, J: jumping enabled (current: %s)", appState.jumpingEnabled ? "yes" : "no"), 10, GetScreenHeight() - 80, 20, BLACK);
             DrawText(TextFormat("S: switch SDF function (current: %s)", appState.sdfFunction == 0 ? "euclidean" : (appState.sdfFunction == 1 ? "chebyshev" : "manhattan")), 10, GetScreenHeight() - 60, 20, BLACK);
             DrawText(TextFormat("Q: Rat wall factor (how much the rat wants to stay close to walls): %d", appState.rat.wallFactor), 10, GetScreenHeight() - 40, 20, BLACK);
@@ -750,6 +781,17 @@ int main(void)
 
     // De-Initialization
     //--------------------------------------------------------------------------------------
+    PathWorkerPool_destroy(appState.workers);
+    PathRequestQueue_destroy(appState.pathRequests);
+    FlowFieldCache_free(&appState.flowFields);
+    CellTexture_free(&appState.mapTexture);
+    CellTexture_free(&appState.pathMapTexture);
+    UnloadTexture(appState.gridLineTexture);
+    Agent_free(&appState.rat);
+    Agent_free(&appState.cat);
+    PathGrid_destroy(appState.grid);
+    PathSearchArena_releaseThread();
+
     CloseWindow();
     //--------------------------------------------------------------------------------------
 
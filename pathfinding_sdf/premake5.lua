@@ -1,4 +1,62 @@
-
 baseName = path.getbasename(os.getcwd())
 
-defineWorkspace(baseName)
\ No newline at end of file
+newoption
+{
+    trigger = "simd",
+    value = "ISA",
+    description = "instruction set for the neighbor evaluation of the pathfinding searches",
+    allowed = {
+        { "none", "scalar code only"},
+        { "sse4", "SSE4.1"},
+        { "avx2", "AVX2"}
+    },
+    default = "none"
+}
+
+-- the core picks the SIMD kernel of the instruction set the compiler targets
+local function selectSimd()
+    filter "options:simd=sse4"
+        vectorextensions "SSE4.1"
+
+    filter "options:simd=avx2"
+        vectorextensions "AVX2"
+
+    filter{}
+end
+
+defineWorkspace(baseName)
+    -- the benchmarks have their own main functions, they are built as separate projects
+    removefiles { "benchmark/**" }
+    selectSimd()
+
+    -- headless projects with the example sources, the benchmark maps and the given main file
+    local function defineHeadlessProject(name, mainFile)
+        project (name)
+            kind "ConsoleApp"
+            location "_build"
+            targetdir "_bin/%{cfg.buildcfg}"
+
+            vpaths 
+            {
+                ["Header Files/*"] = { "**.h"},
+                ["Source Files/*"] = { "**.c"},
+            }
+            files {"*.c", "*.h", "benchmark/benchmark_maps.c", "benchmark/benchmark_maps.h", mainFile}
+            removefiles { baseName .. ".c" }
+
+            includedirs { "./"}
+            -- the benchmarks run headless, raylib is only needed for its header
+            include_raylib()
+
+            selectSimd()
+
+            filter "system:linux"
+                links {"m", "pthread"}
+
+            filter{}
+    end
+
+    -- comparisons of the different search variants, printed for reading
+    defineHeadlessProject(baseName .. "_benchmark", "benchmark/pathfinding_benchmark.c")
+    -- percentiles on a seeded map corpus as CSV, for catching regressions on CI
+    defineHeadlessProject(baseName .. "_suite", "benchmark/pathfinding_suite.c")
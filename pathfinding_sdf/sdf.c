@@ -0,0 +1,525 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - distance field generation
+*
+*   The euclidean distances are calculated with the separable distance transform by
+*   Felzenszwalb and Huttenlocher ("Distance Transforms of Sampled Functions", 2012):
+*   a first pass finds the closest wall in each column, a second pass uses the lower
+*   envelope of parabolas to find the closest of these for each row. The chebyshev and
+*   manhattan distances are exact with two chamfer passes over the grid.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "sdf.h"
+#include "clearance_labels.h"
+
+#include <stdlib.h> // Required for: malloc, free, abs
+#include <limits.h> // Required for: INT_MAX
+#include <math.h> // Required for: sqrt, ceil
+
+// marks cells without any wall in their column during the euclidean transform
+#define SDF_INFINITE -1
+
+// distance of cells without a closest wall
+#define SDF_NO_WALL INT_MAX
+
+// The incremental update keeps the closest wall of every cell. The distances are stored as
+// squared distances for the euclidean function, so they stay exact integers.
+typedef struct SDFState
+{
+    int *sites;
+    int *distances;
+    // set on cells that lost their closest wall and have to pass this on to their neighbors
+    char *raise;
+    char *changed;
+    PathHeap queue;
+    int function;
+} SDFState;
+
+static SDFState *AllocateSDFState(PathGrid *grid)
+{
+    if (grid->sdfState != NULL)
+    {
+        return grid->sdfState;
+    }
+    int cellCount = grid->width * grid->height;
+    SDFState *state = (SDFState *)RL_MALLOC(sizeof(SDFState));
+    state->sites = (int *)RL_MALLOC(cellCount * sizeof(int));
+    state->distances = (int *)RL_MALLOC(cellCount * sizeof(int));
+    state->raise = (char *)RL_CALLOC(cellCount, sizeof(char));
+    state->changed = (char *)RL_CALLOC(cellCount, sizeof(char));
+    state->queue = PathHeap_init(cellCount);
+    state->function = SDF_EUCLIDEAN;
+    grid->sdfChangedCells = (int *)RL_MALLOC(cellCount * sizeof(int));
+    grid->sdfChangedCount = 0;
+    grid->sdfState = state;
+    return state;
+}
+
+void UnloadSDFState(PathGrid *grid)
+{
+    SDFState *state = grid->sdfState;
+    if (state == NULL)
+    {
+        return;
+    }
+    RL_FREE(state->sites);
+    RL_FREE(state->distances);
+    RL_FREE(state->raise);
+    RL_FREE(state->changed);
+    PathHeap_free(&state->queue);
+    RL_FREE(state);
+    RL_FREE(grid->sdfChangedCells);
+    grid->sdfChangedCells = NULL;
+    grid->sdfChangedCount = 0;
+    grid->sdfState = NULL;
+}
+
+// distance between a wall cell and another cell in the units of the stored distances
+static int WallDistance(const PathGrid *grid, int site, int cell)
+{
+    int gridWidth = grid->width;
+    int dx = abs(site % gridWidth - cell % gridWidth);
+    int dy = abs(site / gridWidth - cell / gridWidth);
+    if (grid->sdfState->function == SDF_CHEBYSHEV)
+    {
+        return dx < dy ? dy : dx;
+    }
+    if (grid->sdfState->function == SDF_MANHATTAN)
+    {
+        return dx + dy;
+    }
+    return dx * dx + dy * dy;
+}
+
+// converts a stored distance to the value stored in sdfCells
+static unsigned short SdfValue(const SDFState *state, int distance)
+{
+    if (distance == SDF_NO_WALL)
+    {
+        return SDF_MAX_DISTANCE;
+    }
+    if (state->function == SDF_EUCLIDEAN)
+    {
+        // the SDF stores distances rounded up, like the square root lookup table does
+        distance = (int)ceil(sqrt((double)distance));
+    }
+    return (unsigned short)(distance < SDF_MAX_DISTANCE ? distance : SDF_MAX_DISTANCE);
+}
+
+//------------------------------------------------------------------------------------
+// full recalculation
+//------------------------------------------------------------------------------------
+
+// 1D distance transform of a single row: f holds the squared distances to the closest wall
+// in each column (or SDF_INFINITE), nearest receives the column whose wall is the closest
+// one for each cell of the row (or -1). v and z are scratch arrays of length n and n + 1.
+static void DistanceTransformRow(const int *f, int n, int *v, double *z, int *nearest)
+{
+    // build the lower envelope of the parabolas rooted at the cells that see a wall,
+    // cells without a wall in their column can't contribute and are skipped
+    int k = -1;
+    for (int q = 0; q < n; q++)
+    {
+        if (f[q] == SDF_INFINITE)
+        {
+            continue;
+        }
+        double s = 0.0;
+        while (k >= 0)
+        {
+            int p = v[k];
+            // intersection of the parabolas rooted at p and q
+            s = ((double)f[q] + (double)q * q - (double)f[p] - (double)p * p) / (2.0 * (q - p));
+            if (s > z[k])
+            {
+                break;
+            }
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = k == 0 ? -1e30 : s;
+        z[k + 1] = 1e30;
+    }
+
+    if (k < 0)
+    {
+        // no walls in reach of this row
+        for (int q = 0; q < n; q++)
+        {
+            nearest[q] = -1;
+        }
+        return;
+    }
+
+    // sample the lower envelope
+    int count = k;
+    k = 0;
+    for (int q = 0; q < n; q++)
+    {
+        while (k < count && z[k + 1] < q)
+        {
+            k++;
+        }
+        nearest[q] = v[k];
+    }
+}
+
+static void ComputeEuclideanSDF(PathGrid *grid)
+{
+    SDFState *state = grid->sdfState;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    int *f = (int *)RL_MALLOC(gridWidth * sizeof(int));
+    int *rows = (int *)RL_MALLOC(gridWidth * sizeof(int));
+    int *v = (int *)RL_MALLOC(gridWidth * sizeof(int));
+    int *nearest = (int *)RL_MALLOC(gridWidth * sizeof(int));
+    double *z = (double *)RL_MALLOC((gridWidth + 1) * sizeof(double));
+
+    // first pass: row of the closest wall in the same column, top-down and then bottom-up;
+    // walking rows instead of columns keeps the memory accesses linear
+    for (int x = 0; x < gridWidth; x++)
+    {
+        state->sites[x] = grid->blockedCells[x] == 1 ? 0 : SDF_INFINITE;
+    }
+    for (int y = 1; y < gridHeight; y++)
+    {
+        int *row = &state->sites[y * gridWidth];
+        for (int x = 0; x < gridWidth; x++)
+        {
+            row[x] = grid->blockedCells[y * gridWidth + x] == 1 ? y : row[x - gridWidth];
+        }
+    }
+    for (int y = gridHeight - 2; y >= 0; y--)
+    {
+        int *row = &state->sites[y * gridWidth];
+        for (int x = 0; x < gridWidth; x++)
+        {
+            int below = row[x + gridWidth];
+            if (below != SDF_INFINITE && (row[x] == SDF_INFINITE || below - y < y - row[x]))
+            {
+                row[x] = below;
+            }
+        }
+    }
+
+    // second pass: closest of the column walls along each row
+    for (int y = 0; y < gridHeight; y++)
+    {
+        int *row = &state->sites[y * gridWidth];
+        for (int x = 0; x < gridWidth; x++)
+        {
+            rows[x] = row[x];
+            f[x] = row[x] == SDF_INFINITE ? SDF_INFINITE : (y - row[x]) * (y - row[x]);
+        }
+        DistanceTransformRow(f, gridWidth, v, z, nearest);
+        for (int x = 0; x < gridWidth; x++)
+        {
+            int i = y * gridWidth + x;
+            if (nearest[x] < 0)
+            {
+                state->sites[i] = -1;
+                state->distances[i] = SDF_NO_WALL;
+            }
+            else
+            {
+                int dx = x - nearest[x];
+                state->sites[i] = rows[nearest[x]] * gridWidth + nearest[x];
+                state->distances[i] = dx * dx + f[nearest[x]];
+            }
+        }
+    }
+
+    RL_FREE(f);
+    RL_FREE(rows);
+    RL_FREE(v);
+    RL_FREE(nearest);
+    RL_FREE(z);
+}
+
+// takes over the closest wall of a neighbor if that is closer than the current one
+static void ChamferStep(SDFState *state, int i, int neighbor, int *d)
+{
+    if (state->distances[neighbor] != SDF_NO_WALL && state->distances[neighbor] + 1 < *d)
+    {
+        *d = state->distances[neighbor] + 1;
+        state->sites[i] = state->sites[neighbor];
+    }
+}
+
+// chamfer distance transform: a forward and a backward pass propagate the distances from
+// the already visited neighbors. With unit steps to the 4 direct neighbors the result is the
+// exact manhattan distance, adding the diagonal neighbors makes it the chebyshev distance.
+static void ComputeChamferSDF(PathGrid *grid, int includeDiagonals)
+{
+    SDFState *state = grid->sdfState;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    for (int i = 0; i < gridWidth * gridHeight; i++)
+    {
+        state->sites[i] = grid->blockedCells[i] == 1 ? i : -1;
+        state->distances[i] = grid->blockedCells[i] == 1 ? 0 : SDF_NO_WALL;
+    }
+
+    for (int y = 0; y < gridHeight; y++)
+    {
+        for (int x = 0; x < gridWidth; x++)
+        {
+            int i = y * gridWidth + x;
+            int d = state->distances[i];
+            if (x > 0) ChamferStep(state, i, i - 1, &d);
+            if (y > 0)
+            {
+                ChamferStep(state, i, i - gridWidth, &d);
+                if (includeDiagonals)
+                {
+                    if (x > 0) ChamferStep(state, i, i - gridWidth - 1, &d);
+                    if (x < gridWidth - 1) ChamferStep(state, i, i - gridWidth + 1, &d);
+                }
+            }
+            state->distances[i] = d;
+        }
+    }
+
+    for (int y = gridHeight - 1; y >= 0; y--)
+    {
+        for (int x = gridWidth - 1; x >= 0; x--)
+        {
+            int i = y * gridWidth + x;
+            int d = state->distances[i];
+            if (x < gridWidth - 1) ChamferStep(state, i, i + 1, &d);
+            if (y < gridHeight - 1)
+            {
+                ChamferStep(state, i, i + gridWidth, &d);
+                if (includeDiagonals)
+                {
+                    if (x > 0) ChamferStep(state, i, i + gridWidth - 1, &d);
+                    if (x < gridWidth - 1) ChamferStep(state, i, i + gridWidth + 1, &d);
+                }
+            }
+            state->distances[i] = d;
+        }
+    }
+}
+
+void ComputeSDF(PathGrid *grid, int sdfFunction)
+{
+    SDFState *state = AllocateSDFState(grid);
+    state->function = sdfFunction;
+
+    if (sdfFunction == SDF_CHEBYSHEV)
+    {
+        ComputeChamferSDF(grid, 1);
+    }
+    else if (sdfFunction == SDF_MANHATTAN)
+    {
+        ComputeChamferSDF(grid, 0);
+    }
+    else
+    {
+        ComputeEuclideanSDF(grid);
+    }
+
+    for (int i = 0; i < grid->width * grid->height; i++)
+    {
+        grid->sdfCells[i] = SdfValue(state, state->distances[i]);
+        state->raise[i] = 0;
+    }
+    // pending changes are part of the new SDF already
+    while (state->queue.count > 0)
+    {
+        PathHeap_pop(&state->queue);
+    }
+    grid->sdfChangedCount = 0;
+    grid->sdfVersion++;
+    if (grid->clearanceLabels != NULL)
+    {
+        ClearanceLabels_compute(grid);
+    }
+}
+
+//------------------------------------------------------------------------------------
+// incremental update
+//------------------------------------------------------------------------------------
+static const int sdfNeighborX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+static const int sdfNeighborY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+void SetCellBlocked(PathGrid *grid, int x, int y, int blocked)
+{
+    if (!PathGrid_contains(grid, x, y))
+    {
+        return;
+    }
+    int cell = y * grid->width + x;
+    blocked = blocked ? 1 : 0;
+    if (grid->blockedCells[cell] == blocked)
+    {
+        return;
+    }
+    grid->blockedCells[cell] = blocked;
+    SDFState *state = grid->sdfState;
+    if (state == NULL)
+    {
+        // there is no SDF yet that could be updated
+        return;
+    }
+
+    if (blocked)
+    {
+        // the new wall is its own closest wall and lowers the distances around it
+        state->sites[cell] = cell;
+        state->distances[cell] = 0;
+        state->raise[cell] = 0;
+    }
+    else
+    {
+        // the cell is free and cells that had it as closest wall need to look for another one
+        state->sites[cell] = -1;
+        state->distances[cell] = SDF_NO_WALL;
+        state->raise[cell] = 1;
+    }
+    PathHeap_push(&state->queue, cell, 0);
+}
+
+// a cell that lost its closest wall passes this on to all neighbors that had the same wall,
+// neighbors that still have a valid wall are queued to lower the distances of the raised cells
+static void RaiseCell(PathGrid *grid, int cell, int x, int y)
+{
+    SDFState *state = grid->sdfState;
+    for (int i = 0; i < 8; i++)
+    {
+        int nx = x + sdfNeighborX[i];
+        int ny = y + sdfNeighborY[i];
+        if (!PathGrid_contains(grid, nx, ny))
+        {
+            continue;
+        }
+        int neighbor = ny * grid->width + nx;
+        int site = state->sites[neighbor];
+        if (site < 0 || state->raise[neighbor])
+        {
+            continue;
+        }
+        if (grid->blockedCells[site] != 1)
+        {
+            PathHeap_push(&state->queue, neighbor, state->distances[neighbor]);
+            state->sites[neighbor] = -1;
+            state->distances[neighbor] = SDF_NO_WALL;
+            state->raise[neighbor] = 1;
+        }
+        else if (state->queue.positions[neighbor] < 0)
+        {
+            PathHeap_push(&state->queue, neighbor, state->distances[neighbor]);
+        }
+    }
+    state->raise[cell] = 0;
+}
+
+// offers the closest wall of the cell to its neighbors
+static void LowerCell(PathGrid *grid, int cell, int x, int y)
+{
+    SDFState *state = grid->sdfState;
+    int site = state->sites[cell];
+    for (int i = 0; i < 8; i++)
+    {
+        int nx = x + sdfNeighborX[i];
+        int ny = y + sdfNeighborY[i];
+        if (!PathGrid_contains(grid, nx, ny))
+        {
+            continue;
+        }
+        int neighbor = ny * grid->width + nx;
+        if (state->raise[neighbor])
+        {
+            continue;
+        }
+        int distance = WallDistance(grid, site, neighbor);
+        int neighborSite = state->sites[neighbor];
+        if (distance < state->distances[neighbor] ||
+            (distance == state->distances[neighbor] && (neighborSite < 0 || grid->blockedCells[neighborSite] != 1)))
+        {
+            state->sites[neighbor] = site;
+            state->distances[neighbor] = distance;
+            PathHeap_push(&state->queue, neighbor, distance);
+        }
+    }
+}
+
+int UpdateSDFCells(PathGrid *grid)
+{
+    SDFState *state = grid->sdfState;
+    if (state == NULL)
+    {
+        return 0;
+    }
+    grid->sdfChangedCount = 0;
+    while (state->queue.count > 0)
+    {
+        int cell = PathHeap_pop(&state->queue);
+        int x = cell % grid->width;
+        int y = cell / grid->width;
+        if (state->raise[cell])
+        {
+            RaiseCell(grid, cell, x, y);
+        }
+        else if (state->sites[cell] >= 0 && grid->blockedCells[state->sites[cell]] == 1)
+        {
+            LowerCell(grid, cell, x, y);
+        }
+
+        if (!state->changed[cell])
+        {
+            state->changed[cell] = 1;
+            grid->sdfChangedCells[grid->sdfChangedCount++] = cell;
+        }
+    }
+
+    // only report the cells whose value in sdfCells actually changed
+    int changedCount = 0;
+    for (int i = 0; i < grid->sdfChangedCount; i++)
+    {
+        int cell = grid->sdfChangedCells[i];
+        state->changed[cell] = 0;
+        unsigned short value = SdfValue(state, state->distances[cell]);
+        if (value != grid->sdfCells[cell])
+        {
+            grid->sdfCells[cell] = value;
+            grid->sdfChangedCells[changedCount++] = cell;
+        }
+    }
+    grid->sdfChangedCount = changedCount;
+    if (changedCount > 0)
+    {
+        grid->sdfVersion++;
+        if (grid->clearanceLabels != NULL)
+        {
+            ClearanceLabels_update(grid, grid->sdfChangedCells, changedCount);
+        }
+    }
+    return changedCount;
+}
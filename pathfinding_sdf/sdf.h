@@ -0,0 +1,42 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - distance field generation
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef SDF_H
+#define SDF_H
+
+#include "pathfinding.h"
+
+// values of the sdfFunction that selects how distances to walls are measured
+#define SDF_EUCLIDEAN 0
+#define SDF_CHEBYSHEV 1
+#define SDF_MANHATTAN 2
+
+// distance stored for cells that have no wall in reach (e.g. on an empty map)
+#define SDF_MAX_DISTANCE 0xffff
+
+// recalculates sdfCells from blockedCells in O(width * height), independent of the number of walls
+void ComputeSDF(PathGrid *grid, int sdfFunction);
+// frees the state of the incremental update, PathGrid_destroy calls this
+void UnloadSDFState(PathGrid *grid);
+
+// changes a cell and queues the SDF update around it, walls that are painted and erased again
+// before UpdateSDFCells is called are handled as well
+void SetCellBlocked(PathGrid *grid, int x, int y, int blocked);
+
+// applies the queued cell changes with a dynamic brushfire: new walls lower the distances
+// around them and removed walls raise the distances of the cells that used them as closest
+// wall until cells with another valid wall take over. Only cells whose closest wall changes
+// are touched. Returns the number of cells whose SDF value changed, they are listed in
+// sdfChangedCells of the grid.
+int UpdateSDFCells(PathGrid *grid);
+
+#endif
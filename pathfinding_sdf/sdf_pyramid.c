@@ -0,0 +1,256 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - SDF mip chain
+*
+*   With jumping, a search steps up to the SDF value of a cell minus the unit size, but
+*   never further than the neighbor offsets reach, and in open areas it still reaches
+*   every cell. The mip chain reduces the SDF to squares of 2, 4, 8, ... cells, each holding
+*   the smallest SDF value inside. Where a square has enough room, the search only steps to
+*   the corners of the squares of that size, with the neighbor offsets scaled by the square
+*   size; near walls the squares get smaller until the search steps from cell to cell. The
+*   levels are nested, the corners of a level are corners of all finer levels as well, so
+*   the search moves between the levels without detours.
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "sdf_pyramid.h"
+#include "sdf.h"
+#include "clearance_labels.h"
+#include "incremental_planner.h"
+
+#include <stdlib.h> // Required for: malloc, free, qsort
+#include <math.h> // Required for: sqrtf, ceilf
+
+static int CompareOffsets(const void *a, const void *b)
+{
+    return ((const NeighborOffset *)a)->distance - ((const NeighborOffset *)b)->distance;
+}
+
+SDFPyramid SDFPyramid_init(PathGrid *grid, int levelCount)
+{
+    SDFPyramid pyramid = { 0 };
+    pyramid.grid = grid;
+    pyramid.levelCount = clamp(levelCount, 1, SDF_PYRAMID_MAX_LEVELS);
+    for (int level = 0; level < pyramid.levelCount; level++)
+    {
+        int size = 1 << level;
+        pyramid.widths[level] = (grid->width + size - 1) / size;
+        pyramid.heights[level] = (grid->height + size - 1) / size;
+        if (level > 0)
+        {
+            pyramid.levels[level] = (unsigned short *)RL_MALLOC(pyramid.widths[level] * pyramid.heights[level] * sizeof(unsigned short));
+        }
+    }
+    pyramid.levels[0] = grid->sdfCells;
+
+    pyramid.offsets = (NeighborOffset *)RL_MALLOC(neighborOffsetCount * sizeof(NeighborOffset));
+    for (int i = 0; i < neighborOffsetCount; i++)
+    {
+        pyramid.offsets[i] = neighborOffsets[i];
+    }
+    qsort(pyramid.offsets, neighborOffsetCount, sizeof(NeighborOffset), CompareOffsets);
+    // the levels are reduced by the first update
+    pyramid.sdfVersion = grid->sdfVersion - 1;
+    return pyramid;
+}
+
+void SDFPyramid_free(SDFPyramid *pyramid)
+{
+    for (int level = 1; level < pyramid->levelCount; level++)
+    {
+        RL_FREE(pyramid->levels[level]);
+        pyramid->levels[level] = NULL;
+    }
+    pyramid->levelCount = 0;
+    RL_FREE(pyramid->offsets);
+    pyramid->offsets = NULL;
+}
+
+void SDFPyramid_update(SDFPyramid *pyramid)
+{
+    if (pyramid->sdfVersion == pyramid->grid->sdfVersion)
+    {
+        return;
+    }
+
+    // each level is the minimum of 2x2 cells of the level before, the squares at the right
+    // and bottom border may cover fewer cells
+    for (int level = 1; level < pyramid->levelCount; level++)
+    {
+        const unsigned short *finer = pyramid->levels[level - 1];
+        int finerWidth = pyramid->widths[level - 1];
+        int finerHeight = pyramid->heights[level - 1];
+        for (int y = 0; y < pyramid->heights[level]; y++)
+        {
+            for (int x = 0; x < pyramid->widths[level]; x++)
+            {
+                int value = SDF_MAX_DISTANCE;
+                for (int j = y * 2; j < y * 2 + 2 && j < finerHeight; j++)
+                {
+                    for (int i = x * 2; i < x * 2 + 2 && i < finerWidth; i++)
+                    {
+                        int finerValue = finer[j * finerWidth + i];
+                        value = finerValue < value ? finerValue : value;
+                    }
+                }
+                pyramid->levels[level][y * pyramid->widths[level] + x] = (unsigned short)value;
+            }
+        }
+    }
+    pyramid->sdfVersion = pyramid->grid->sdfVersion;
+}
+
+// the coarsest level whose square around the cell leaves room for steps of one and a half
+// times the square size, so the cell reaches the corners around it; 0 close to walls. More
+// room would cost more expansions, less makes the paths zigzag over the coarse lattice.
+static int CellLevel(const SDFPyramid *pyramid, int x, int y, int unitSize)
+{
+    for (int level = pyramid->levelCount - 1; level > 0; level--)
+    {
+        int spacing = 1 << level;
+        if (SDFPyramid_value(pyramid, level, x, y) - unitSize >= spacing + spacing / 2)
+        {
+            return level;
+        }
+    }
+    return 0;
+}
+
+// rounded up like the distances of the neighbor offsets, steps can be longer than the table
+static int StepDistance(int dx, int dy)
+{
+    int squaredDistance = dx * dx + dy * dy;
+    return squaredDistance < 256 ? isqrt[squaredDistance] : (int)ceilf(sqrtf((float)squaredDistance));
+}
+
+static void QueueStep(Agent *agent, PathHeap *queue, int cell, int cellSdf, int x, int y, int stepDistance)
+{
+    const PathGrid *grid = agent->grid;
+    int next = y * grid->width + x;
+    int nextSdf = grid->sdfCells[next];
+    if (nextSdf < agent->unitSize)
+    {
+        return;
+    }
+    int score = agent->map.scores[cell] + PathStepScore(cellSdf, nextSdf, stepDistance, agent->wallFactor);
+    int nextScore = PathMap_score(&agent->map, next);
+    if (nextScore == 0 || score < nextScore)
+    {
+        PathMap_set(&agent->map, next, cell, score);
+        PathHeap_push(queue, next, score);
+    }
+}
+
+void Agent_findPathMultiResolution(Agent *agent, SDFPyramid *pyramid)
+{
+    SDFPyramid_update(pyramid);
+    if (!PathGrid_isReachable(agent->grid, agent->unitSize, agent->startX, agent->startY, agent->targetX, agent->targetY))
+    {
+        // Agent_findPath rejects the search without expanding any node
+        Agent_findPath(agent, 1);
+        return;
+    }
+
+    const PathGrid *grid = agent->grid;
+    int gridWidth = grid->width;
+    int gridHeight = grid->height;
+    const unsigned short *sdfCells = grid->sdfCells;
+    int unitSize = agent->unitSize;
+    PathHeap *queue = &PathSearchArena_get(gridWidth * gridHeight)->queue;
+    PathMap *map = &agent->map;
+    PathMap_reset(map);
+    if (agent->planner != NULL)
+    {
+        // the map of this search can't be repaired, a fallback to Agent_findPath syncs again
+        IncrementalPlanner_invalidate(agent);
+    }
+
+    // like in Agent_findPath, the search runs from the target to the start
+    int goalX = agent->startX;
+    int goalY = agent->startY;
+    int goalCell = goalY * gridWidth + goalX;
+    PathMap_set(map, agent->targetY * gridWidth + agent->targetX, PATH_NO_PARENT, 1);
+    PathHeap_push(queue, agent->targetY * gridWidth + agent->targetX, 1);
+
+    int expandedCount = 0;
+    while (queue->count > 0)
+    {
+        int cell = PathHeap_pop(queue);
+        expandedCount++;
+        if (cell == goalCell)
+        {
+            break;
+        }
+
+        int cellX = cell % gridWidth;
+        int cellY = cell / gridWidth;
+        int cellSdf = sdfCells[cell];
+        // every cell closer than this is free for the unit, the steps stay inside
+        int reach = PathMaxStepDistance(cellSdf, unitSize);
+
+        // the start is not on the lattice of coarse levels, it is stepped to directly once
+        // it is in reach
+        int goalDistance = StepDistance(goalX - cellX, goalY - cellY);
+        if (goalDistance <= reach)
+        {
+            QueueStep(agent, queue, cell, cellSdf, goalX, goalY, goalDistance);
+        }
+
+        // the offsets are scaled to the spacing of the level and start at the corner of the
+        // square, so all cells of the same square step to the same lattice
+        int level = CellLevel(pyramid, cellX, cellY, unitSize);
+        int spacing = 1 << level;
+        int cornerX = cellX & ~(spacing - 1);
+        int cornerY = cellY & ~(spacing - 1);
+        int maxOffsetDistance = reach / spacing > 1 ? reach / spacing : 1;
+        for (int i = 0; i < neighborOffsetCount && pyramid->offsets[i].distance <= maxOffsetDistance; i++)
+        {
+            int x = cornerX + pyramid->offsets[i].x * spacing;
+            int y = cornerY + pyramid->offsets[i].y * spacing;
+            if (x < 0 || x >= gridWidth || y < 0 || y >= gridHeight)
+            {
+                continue;
+            }
+            int stepDistance = StepDistance(x - cellX, y - cellY);
+            if (stepDistance > reach)
+            {
+                continue;
+            }
+            QueueStep(agent, queue, cell, cellSdf, x, y, stepDistance);
+        }
+    }
+    agent->expandedCount = expandedCount;
+    PathHeap_clear(queue);
+    Agent_extractPath(agent);
+
+    if (agent->pathCount == 0)
+    {
+        // the lattices can miss narrow gaps next to open areas, the full search doesn't
+        Agent_findPath(agent, 1);
+        agent->expandedCount += expandedCount;
+    }
+}
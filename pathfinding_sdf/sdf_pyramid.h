@@ -0,0 +1,56 @@
+/**********************************************************************************************
+*
+*   raylib-extras, examples-c * examples for Raylib in C
+*
+*   pathfinding in combination with signed distance fields - SDF mip chain
+*
+*   LICENSE: ZLib
+*
+*   Copyright (c) 2024 Eike Decker
+*
+**********************************************************************************************/
+
+#ifndef SDF_PYRAMID_H
+#define SDF_PYRAMID_H
+
+#include "pathfinding.h"
+
+// level 0 is the SDF itself, the cells of the last level cover 32x32 cells of the grid
+#define SDF_PYRAMID_MAX_LEVELS 6
+
+// mip chain of the SDF: a cell of level k holds the smallest SDF value of the 2^k x 2^k grid
+// cells it covers, so it tells how much room a unit has anywhere in that square
+typedef struct SDFPyramid
+{
+    PathGrid *grid;
+    int levelCount;
+    int widths[SDF_PYRAMID_MAX_LEVELS];
+    int heights[SDF_PYRAMID_MAX_LEVELS];
+    // level 0 points to the SDF of the grid, the other levels are owned by the pyramid
+    unsigned short *levels[SDF_PYRAMID_MAX_LEVELS];
+    // sdfVersion of the grid the levels were reduced from
+    int sdfVersion;
+    // neighbor offsets sorted by distance, so the steps of a cell end at its max distance
+    NeighborOffset *offsets;
+} SDFPyramid;
+
+SDFPyramid SDFPyramid_init(PathGrid *grid, int levelCount);
+void SDFPyramid_free(SDFPyramid *pyramid);
+
+// reduces the levels again if the SDF of the grid changed since the last update
+void SDFPyramid_update(SDFPyramid *pyramid);
+
+// smallest SDF value in the square of the given level that contains the grid cell
+static inline int SDFPyramid_value(const SDFPyramid *pyramid, int level, int x, int y)
+{
+    return pyramid->levels[level][(y >> level) * pyramid->widths[level] + (x >> level)];
+}
+
+// searches like Agent_findPath with jumping, but in open areas the steps go to the lattice
+// of a coarser level, whose spacing doubles with each level, instead of to every cell. Close
+// to walls the levels get finer until the search steps like Agent_findPath. The search
+// stops when it reaches the start, its map is no flow field. Falls back to Agent_findPath
+// if it doesn't reach the start, the pyramid is updated if the SDF changed.
+void Agent_findPathMultiResolution(Agent *agent, SDFPyramid *pyramid);
+
+#endif